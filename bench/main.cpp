@@ -0,0 +1,461 @@
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "editor/entity/util/Transform.h"
+#include "raytracer/util/RayCamera.h"
+#include "raytracer/hittable/HittableList.h"
+#include "raytracer/hittable/RayShapes.h"
+#include "raytracer/hittable/RayMesh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct BenchScene {
+    HittableList world;
+    RayLightList lights;
+    Transform camera;
+    Color skyboxColor{0.02f};
+    int maxDepth = 5;
+    size_t primitives = 0;
+    size_t triangles = 0;
+
+    void add(std::shared_ptr<Hittable> object) {
+        world.add(object);
+        primitives++;
+    }
+};
+
+struct BenchCase {
+    const char* name;
+    std::function<void(BenchScene&)> build;
+};
+
+struct BenchRun {
+    double buildSeconds = 0.0;
+    double firstSampleSeconds = 0.0;
+    double renderSeconds = 0.0;
+    double megaRaysPerSecond = 0.0;
+    uint64_t rays = 0;
+};
+
+struct Summary {
+    double min = 0.0, median = 0.0, mean = 0.0, stddev = 0.0;
+};
+
+struct BenchConfig {
+    int width = 320;
+    int samplesPerPixel = 8;
+    int runs = 5;
+    int warmup = 1;
+    Integrator integrator = Integrator::Megakernel;
+    bool sortRays = false;
+    bool cacheOccluders = true;
+    LightSelection lightSelection = LightSelection::All;
+    int lightSamples = 1;
+    bool progressive = false;
+    std::string filter;
+    std::string output = "bench_results.json";
+};
+
+static std::shared_ptr<RayMaterial> makeMaterial(const Color& albedo, float metallic, float roughness) {
+    return std::make_shared<PBR>(albedo, metallic, roughness);
+}
+
+static Transform makeTransform(const glm::vec3& position, const glm::vec3& rotation = glm::vec3(0.0f), const glm::vec3& scale = glm::vec3(1.0f)) {
+    Transform transform;
+    transform.position = position;
+    transform.rotation = rotation;
+    transform.scale = scale;
+    return transform;
+}
+
+static void addVertex(std::vector<float>& verts, const glm::vec3& p, const glm::vec3& n) {
+    verts.insert(verts.end(), {p.x, p.y, p.z, n.x, n.y, n.z});
+}
+
+static void addGrid(std::vector<unsigned int>& indices, unsigned int base, int rows, int columns) {
+    for (int r = 0; r < rows; r++) {
+        for (int c = 0; c < columns; c++) {
+            unsigned int i0 = base + r * (columns + 1) + c;
+            unsigned int i1 = i0 + columns + 1;
+            indices.insert(indices.end(), {i0, i1, i0 + 1, i0 + 1, i1, i1 + 1});
+        }
+    }
+}
+
+static void addLumpySphere(std::vector<float>& verts, std::vector<unsigned int>& indices, int rings, int segments) {
+    unsigned int base = (unsigned int)(verts.size() / 6);
+    for (int r = 0; r <= rings; r++) {
+        float theta = glm::pi<float>() * float(r) / float(rings);
+        for (int s = 0; s <= segments; s++) {
+            float phi = 2.0f * glm::pi<float>() * float(s) / float(segments);
+            glm::vec3 n(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            float radius = 1.0f + 0.05f * std::sin(12.0f * theta) * std::sin(12.0f * phi);
+            addVertex(verts, n * radius, n);
+        }
+    }
+    addGrid(indices, base, rings, segments);
+}
+
+static void addCone(std::vector<float>& verts, std::vector<unsigned int>& indices, const glm::vec3& base, float bottomRadius, float topRadius, float height, int rings, int segments) {
+    unsigned int first = (unsigned int)(verts.size() / 6);
+    float slope = (bottomRadius - topRadius) / height;
+    for (int r = 0; r <= rings; r++) {
+        float t = float(r) / float(rings);
+        float radius = glm::mix(bottomRadius, topRadius, t);
+        for (int s = 0; s <= segments; s++) {
+            float phi = 2.0f * glm::pi<float>() * float(s) / float(segments);
+            glm::vec3 dir(std::cos(phi), 0.0f, std::sin(phi));
+            addVertex(verts, base + dir * radius + glm::vec3(0.0f, height * t, 0.0f), glm::normalize(dir + glm::vec3(0.0f, slope, 0.0f)));
+        }
+    }
+    addGrid(indices, first, rings, segments);
+}
+
+static void buildPrimitives(BenchScene& scene) {
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> jitter(-0.2f, 0.2f);
+
+    std::vector<std::shared_ptr<RayMaterial>> materials;
+    for (int i = 0; i < 8; i++)
+        materials.push_back(makeMaterial(Color(0.2f + 0.1f * i, 0.8f - 0.08f * i, 0.5f), (i % 3) * 0.4f, 0.2f + 0.1f * (i % 4)));
+
+    scene.add(std::make_shared<RayPlane>(makeTransform(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(60.0f, 1.0f, 60.0f)), makeMaterial(Color(0.6f), 0.0f, 0.8f)));
+
+    const int grid = 24;
+    for (int z = 0; z < grid; z++) {
+        for (int x = 0; x < grid; x++) {
+            Transform transform = makeTransform(glm::vec3(x - grid / 2 + jitter(rng), 0.5f, z - grid / 2 + jitter(rng)), glm::vec3(0.0f, jitter(rng) * 200.0f, 0.0f), glm::vec3(0.6f));
+            std::shared_ptr<RayMaterial> material = materials[(x + z) % materials.size()];
+
+            switch ((x + z * 3) % 5) {
+                case 0: scene.add(std::make_shared<RaySphere>(transform, material)); break;
+                case 1: scene.add(std::make_shared<RayCube>(transform, material)); break;
+                case 2: scene.add(std::make_shared<RayCylinder>(transform, material)); break;
+                case 3: scene.add(std::make_shared<RayCone>(transform, material)); break;
+                default: scene.add(std::make_shared<RayTorus>(transform, material)); break;
+            }
+        }
+    }
+
+    scene.lights.add(std::make_shared<RayDirectionalLight>(Color(1.0f), 1.5f, makeTransform(glm::vec3(0.0f), glm::vec3(-50.0f, 30.0f, 0.0f))));
+    scene.lights.add(std::make_shared<RayPointLight>(Color(1.0f, 0.8f, 0.6f), 20.0f, makeTransform(glm::vec3(0.0f, 4.0f, 0.0f))));
+    scene.camera = makeTransform(glm::vec3(-14.0f, 8.0f, 14.0f), glm::vec3(-30.0f, -45.0f, 0.0f));
+}
+
+static void buildMesh(BenchScene& scene) {
+    std::vector<float> verts;
+    std::vector<unsigned int> indices;
+    addLumpySphere(verts, indices, 256, 512);
+
+    auto mesh = std::make_shared<MeshBVH>(verts, indices);
+    scene.triangles += mesh->triangleCount();
+
+    scene.add(std::make_shared<RayPlane>(makeTransform(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(20.0f, 1.0f, 20.0f)), makeMaterial(Color(0.6f), 0.0f, 0.8f)));
+    scene.add(std::make_shared<RayMesh>(mesh, makeTransform(glm::vec3(0.0f, 1.5f, 0.0f), glm::vec3(0.0f), glm::vec3(1.5f)), makeMaterial(Color(0.8f, 0.4f, 0.3f), 0.3f, 0.3f)));
+
+    scene.lights.add(std::make_shared<RayPointLight>(Color(1.0f), 15.0f, makeTransform(glm::vec3(3.0f, 5.0f, 3.0f))));
+    scene.camera = makeTransform(glm::vec3(-4.0f, 3.0f, 4.0f), glm::vec3(-20.0f, -45.0f, 0.0f));
+}
+
+static void buildLights(BenchScene& scene) {
+    scene.add(std::make_shared<RayPlane>(makeTransform(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(30.0f, 1.0f, 30.0f)), makeMaterial(Color(0.6f), 0.0f, 0.8f)));
+
+    for (int i = 0; i < 8; i++) {
+        float angle = 2.0f * glm::pi<float>() * i / 8.0f;
+        scene.add(std::make_shared<RaySphere>(makeTransform(glm::vec3(3.0f * std::cos(angle), 0.5f, 3.0f * std::sin(angle))), makeMaterial(Color(0.7f), 0.2f, 0.4f)));
+    }
+
+    for (int i = 0; i < 64; i++) {
+        float angle = 2.0f * glm::pi<float>() * i / 64.0f;
+        float radius = 5.0f + (i % 4);
+        Color color(0.5f + 0.5f * std::sin(angle), 0.5f + 0.5f * std::cos(angle), 0.6f);
+        scene.lights.add(std::make_shared<RayPointLight>(color, 1.0f, makeTransform(glm::vec3(radius * std::cos(angle), 1.0f + (i % 3), radius * std::sin(angle)))));
+    }
+
+    for (int i = 0; i < 16; i++) {
+        float angle = 2.0f * glm::pi<float>() * i / 16.0f;
+        scene.lights.add(std::make_shared<RaySpotLight>(Color(1.0f), 4.0f, makeTransform(glm::vec3(3.0f * std::cos(angle), 4.0f, 3.0f * std::sin(angle)), glm::vec3(-90.0f, 0.0f, 0.0f)), 40.0f, 0.2f));
+    }
+
+    scene.camera = makeTransform(glm::vec3(-8.0f, 6.0f, 8.0f), glm::vec3(-30.0f, -45.0f, 0.0f));
+}
+
+static void buildBounces(BenchScene& scene) {
+    auto wall = makeMaterial(Color(0.8f), 0.0f, 0.6f);
+    scene.add(std::make_shared<RayCube>(makeTransform(glm::vec3(0.0f, -0.1f, 0.0f), glm::vec3(0.0f), glm::vec3(10.0f, 0.2f, 10.0f)), wall));
+    scene.add(std::make_shared<RayCube>(makeTransform(glm::vec3(0.0f, 6.1f, 0.0f), glm::vec3(0.0f), glm::vec3(10.0f, 0.2f, 10.0f)), wall));
+    scene.add(std::make_shared<RayCube>(makeTransform(glm::vec3(0.0f, 3.0f, -5.1f), glm::vec3(0.0f), glm::vec3(10.0f, 6.0f, 0.2f)), makeMaterial(Color(0.8f, 0.3f, 0.3f), 0.0f, 0.6f)));
+    scene.add(std::make_shared<RayCube>(makeTransform(glm::vec3(-5.1f, 3.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.2f, 6.0f, 10.0f)), makeMaterial(Color(0.3f, 0.8f, 0.3f), 0.0f, 0.6f)));
+    scene.add(std::make_shared<RayCube>(makeTransform(glm::vec3(5.1f, 3.0f, 0.0f), glm::vec3(0.0f), glm::vec3(0.2f, 6.0f, 10.0f)), makeMaterial(Color(0.3f, 0.3f, 0.8f), 0.0f, 0.6f)));
+
+    for (int i = 0; i < 9; i++) {
+        glm::vec3 position(-3.0f + 3.0f * (i % 3), 0.75f, -3.0f + 3.0f * (i / 3));
+        scene.add(std::make_shared<RaySphere>(makeTransform(position, glm::vec3(0.0f), glm::vec3(1.5f)), makeMaterial(Color(0.95f), 1.0f, 0.02f + 0.03f * i)));
+    }
+
+    scene.lights.add(std::make_shared<RayPointLight>(Color(1.0f), 12.0f, makeTransform(glm::vec3(0.0f, 5.0f, 0.0f))));
+    scene.camera = makeTransform(glm::vec3(0.0f, 3.0f, 4.8f), glm::vec3(-15.0f, -90.0f, 0.0f));
+    scene.maxDepth = 32;
+}
+
+static void buildForest(BenchScene& scene) {
+    std::vector<float> verts;
+    std::vector<unsigned int> indices;
+    addCone(verts, indices, glm::vec3(0.0f), 0.15f, 0.12f, 1.0f, 4, 16);
+    for (int i = 0; i < 3; i++)
+        addCone(verts, indices, glm::vec3(0.0f, 0.8f + 0.6f * i, 0.0f), 0.9f - 0.2f * i, 0.0f, 1.2f, 8, 48);
+
+    auto tree = std::make_shared<MeshBVH>(verts, indices);
+    auto bark = makeMaterial(Color(0.35f, 0.25f, 0.15f), 0.0f, 0.9f);
+    auto leaves = makeMaterial(Color(0.15f, 0.5f, 0.2f), 0.0f, 0.7f);
+
+    scene.add(std::make_shared<RayPlane>(makeTransform(glm::vec3(0.0f), glm::vec3(0.0f), glm::vec3(60.0f, 1.0f, 60.0f)), makeMaterial(Color(0.4f, 0.35f, 0.3f), 0.0f, 0.9f)));
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f);
+    std::uniform_real_distribution<float> rotation(0.0f, 360.0f);
+    std::uniform_real_distribution<float> scale(0.7f, 1.6f);
+
+    for (int i = 0; i < 400; i++) {
+        float s = scale(rng);
+        Transform transform = makeTransform(glm::vec3(position(rng), 0.0f, position(rng)), glm::vec3(0.0f, rotation(rng), 0.0f), glm::vec3(s));
+        scene.add(std::make_shared<RayMesh>(tree, transform, i % 5 == 0 ? bark : leaves));
+        scene.triangles += tree->triangleCount();
+    }
+
+    scene.lights.add(std::make_shared<RayDirectionalLight>(Color(1.0f, 0.95f, 0.85f), 2.0f, makeTransform(glm::vec3(0.0f), glm::vec3(-40.0f, 60.0f, 0.0f))));
+    scene.camera = makeTransform(glm::vec3(-24.0f, 6.0f, 24.0f), glm::vec3(-12.0f, -45.0f, 0.0f));
+}
+
+static Summary summarize(std::vector<double> values) {
+    Summary summary;
+    if (values.empty())
+        return summary;
+
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    summary.min = values.front();
+    summary.median = n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+
+    for (double v : values)
+        summary.mean += v;
+    summary.mean /= double(n);
+
+    for (double v : values)
+        summary.stddev += (v - summary.mean) * (v - summary.mean);
+    summary.stddev = n > 1 ? std::sqrt(summary.stddev / double(n - 1)) : 0.0;
+
+    return summary;
+}
+
+static BenchRun runOnce(const BenchCase& benchCase, const BenchConfig& config, BenchScene& scene) {
+    using Clock = std::chrono::steady_clock;
+    BenchRun run;
+
+    auto buildStart = Clock::now();
+    scene = BenchScene();
+    benchCase.build(scene);
+    scene.world.build();
+    scene.lights.build();
+    run.buildSeconds = std::chrono::duration<double>(Clock::now() - buildStart).count();
+
+    RayCamera camera;
+    camera.aspectRatio() = 16.0f / 9.0f;
+    camera.imageWidth() = config.width;
+    camera.maxDepth() = scene.maxDepth;
+    camera.skyboxColor() = scene.skyboxColor;
+    camera.transform() = scene.camera;
+    camera.denoise() = !config.progressive;
+    camera.integrator() = config.integrator;
+    camera.sortRays() = config.sortRays;
+    camera.cacheOccluders() = config.cacheOccluders;
+    camera.lightSelection() = config.lightSelection;
+    camera.lightSamples() = config.lightSamples;
+
+    int height = std::max(int(config.width / camera.aspectRatio()), 1);
+    std::vector<unsigned char> display(size_t(config.width) * height * 3);
+    camera.imageDataBuffer = display.data();
+
+    if (config.progressive) {
+        std::atomic<bool> cancel = false;
+        auto renderStart = Clock::now();
+        camera.beginProgressive();
+        while (camera.progressiveSamples() < config.samplesPerPixel) {
+            camera.renderPass(scene.world, scene.lights, cancel);
+            if (camera.progressiveSamples() == 1 && run.firstSampleSeconds == 0.0)
+                run.firstSampleSeconds = std::chrono::duration<double>(Clock::now() - renderStart).count();
+        }
+        run.renderSeconds = std::chrono::duration<double>(Clock::now() - renderStart).count();
+    } else {
+        camera.samplesPerPixel() = 1;
+        auto firstStart = Clock::now();
+        camera.render(scene.world, scene.lights);
+        run.firstSampleSeconds = std::chrono::duration<double>(Clock::now() - firstStart).count();
+
+        camera.samplesPerPixel() = config.samplesPerPixel;
+        auto renderStart = Clock::now();
+        camera.render(scene.world, scene.lights);
+        run.renderSeconds = std::chrono::duration<double>(Clock::now() - renderStart).count();
+    }
+
+    run.rays = camera.stats().rays();
+    run.megaRaysPerSecond = double(run.rays) / run.renderSeconds * 1e-6;
+    return run;
+}
+
+static void writeSummary(std::ofstream& file, const char* name, const Summary& summary, bool last) {
+    file << "                \"" << name << "\": {\"min\": " << summary.min << ", \"median\": " << summary.median
+         << ", \"mean\": " << summary.mean << ", \"stddev\": " << summary.stddev << "}" << (last ? "\n" : ",\n");
+}
+
+static void printUsage() {
+    std::cout << "Usage: radiance-bench [--width N] [--spp N] [--runs N] [--warmup N] [--integrator megakernel|wavefront] [--sort-rays] [--no-occluder-cache] [--lights all|power|nearby|tree] [--light-samples N] [--progressive] [--scene NAME] [--output PATH]\n";
+}
+
+static bool parseArguments(int argc, char** argv, BenchConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--width" && hasValue) config.width = std::max(std::atoi(argv[++i]), 16);
+        else if (arg == "--spp" && hasValue) config.samplesPerPixel = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--runs" && hasValue) config.runs = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--warmup" && hasValue) config.warmup = std::max(std::atoi(argv[++i]), 0);
+        else if (arg == "--integrator" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "megakernel") config.integrator = Integrator::Megakernel;
+            else if (name == "wavefront") config.integrator = Integrator::Wavefront;
+            else return false;
+        }
+        else if (arg == "--sort-rays") config.sortRays = true;
+        else if (arg == "--no-occluder-cache") config.cacheOccluders = false;
+        else if (arg == "--lights" && hasValue) {
+            std::string name = argv[++i];
+            if (name == "all") config.lightSelection = LightSelection::All;
+            else if (name == "power") config.lightSelection = LightSelection::Power;
+            else if (name == "nearby") config.lightSelection = LightSelection::Nearby;
+            else if (name == "tree") config.lightSelection = LightSelection::Tree;
+            else return false;
+        }
+        else if (arg == "--light-samples" && hasValue) config.lightSamples = std::max(std::atoi(argv[++i]), 1);
+        else if (arg == "--progressive") config.progressive = true;
+        else if (arg == "--scene" && hasValue) config.filter = argv[++i];
+        else if (arg == "--output" && hasValue) config.output = argv[++i];
+        else return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    BenchConfig config;
+    if (!parseArguments(argc, argv, config)) {
+        printUsage();
+        return 1;
+    }
+
+    const std::vector<BenchCase> cases = {
+        {"primitives", buildPrimitives},
+        {"mesh", buildMesh},
+        {"lights", buildLights},
+        {"bounces", buildBounces},
+        {"forest", buildForest}
+    };
+
+    std::ofstream file(config.output);
+    if (!file) {
+        std::cerr << "Failed to open " << config.output << std::endl;
+        return 1;
+    }
+
+#if defined(RADIANCE_SIMD_SSE2)
+    const char* simd = "sse2";
+#elif defined(RADIANCE_SIMD_NEON)
+    const char* simd = "neon";
+#else
+    const char* simd = "scalar";
+#endif
+
+    file << "{\n";
+    file << "    \"config\": {\"width\": " << config.width << ", \"samplesPerPixel\": " << config.samplesPerPixel
+         << ", \"runs\": " << config.runs << ", \"warmup\": " << config.warmup
+         << ", \"path\": \"" << (config.progressive ? "progressive" : "final") << "\""
+         << ", \"integrator\": \"" << integratorNames[(int)config.integrator] << "\""
+         << ", \"sortRays\": " << (config.sortRays ? "true" : "false")
+         << ", \"cacheOccluders\": " << (config.cacheOccluders ? "true" : "false")
+         << ", \"lightSelection\": \"" << lightSelectionNames[(int)config.lightSelection] << "\", \"lightSamples\": " << config.lightSamples << "},\n";
+    file << "    \"machine\": {\"threads\": " << std::thread::hardware_concurrency() << ", \"simd\": \"" << simd << "\"},\n";
+    file << "    \"scenes\": [";
+
+    std::printf("%-12s %8s %10s %10s %10s %10s %18s\n", "scene", "objects", "triangles", "build ms", "1 spp ms", "N spp ms", "Mrays/s");
+
+    bool first = true;
+    for (const BenchCase& benchCase : cases) {
+        if (!config.filter.empty() && config.filter != benchCase.name)
+            continue;
+
+        BenchScene scene;
+        for (int i = 0; i < config.warmup; i++)
+            runOnce(benchCase, config, scene);
+
+        std::vector<BenchRun> runs;
+        for (int i = 0; i < config.runs; i++)
+            runs.push_back(runOnce(benchCase, config, scene));
+
+        auto collect = [&](double BenchRun::* member) {
+            std::vector<double> values;
+            for (const BenchRun& run : runs)
+                values.push_back(run.*member);
+            return summarize(values);
+        };
+
+        Summary build = collect(&BenchRun::buildSeconds);
+        Summary firstSample = collect(&BenchRun::firstSampleSeconds);
+        Summary render = collect(&BenchRun::renderSeconds);
+        Summary rate = collect(&BenchRun::megaRaysPerSecond);
+
+        std::printf("%-12s %8zu %10zu %10.2f %10.2f %10.2f %9.3f +- %.3f\n", benchCase.name, scene.primitives, scene.triangles,
+                    build.median * 1e3, firstSample.median * 1e3, render.median * 1e3, rate.median, rate.stddev);
+
+        file << (first ? "\n" : ",\n");
+        first = false;
+
+        file << "        {\n";
+        file << "            \"name\": \"" << benchCase.name << "\",\n";
+        file << "            \"objects\": " << scene.primitives << ",\n";
+        file << "            \"triangles\": " << scene.triangles << ",\n";
+        file << "            \"lights\": " << scene.lights.lights.size() << ",\n";
+        file << "            \"maxDepth\": " << scene.maxDepth << ",\n";
+        file << "            \"runs\": [";
+        for (size_t i = 0; i < runs.size(); i++) {
+            const BenchRun& run = runs[i];
+            file << (i ? ", " : "") << "{\"buildSeconds\": " << run.buildSeconds << ", \"firstSampleSeconds\": " << run.firstSampleSeconds
+                 << ", \"renderSeconds\": " << run.renderSeconds << ", \"rays\": " << run.rays << ", \"megaRaysPerSecond\": " << run.megaRaysPerSecond << "}";
+        }
+        file << "],\n";
+        file << "            \"summary\": {\n";
+        writeSummary(file, "buildSeconds", build, false);
+        writeSummary(file, "firstSampleSeconds", firstSample, false);
+        writeSummary(file, "renderSeconds", render, false);
+        writeSummary(file, "megaRaysPerSecond", rate, true);
+        file << "            }\n";
+        file << "        }";
+    }
+
+    file << "\n    ]\n}\n";
+    std::cout << "Results written to " << config.output << std::endl;
+    return 0;
+}
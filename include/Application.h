@@ -18,13 +18,23 @@
 #include "editor/entity/light/LightList.h"
 
 #include "raytracer/Raytracer.h"
+#include "raytracer/SceneReplicas.h"
+#include "raytracer/ProgressiveRenderer.h"
+#include "raytracer/SequenceRenderer.h"
+#include "raytracer/StreamingRenderer.h"
+#include "raytracer/output/RenderOutput.h"
+#ifndef _WIN32
+#include "raytracer/distributed/RenderCoordinator.h"
+#endif
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include "editor/Exporter.h"
 #include "editor/MeshImporter.h"
 #include "editor/Importer.h"
+#include "editor/RenderPreview.h"
 #include <mutex>
+#include <filesystem>
 #include "ImGuizmo.h"
 
 class Application {
@@ -95,11 +105,20 @@ class Application {
 
             initializeFramebuffer();
 
-            glGenTextures(1, &_renderId);
-            glBindTexture(GL_TEXTURE_2D, _renderId);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-            glBindTexture(GL_TEXTURE_2D, 0);
+            _preview = std::make_unique<RenderPreview>();
+            _viewportPreview = std::make_unique<RenderPreview>();
+
+            glGenFramebuffers(1, &_viewportPreviewFBO);
+            glBindFramebuffer(GL_FRAMEBUFFER, _viewportPreviewFBO);
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _viewportPreview->getTexture(), 0);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+            _progressive.onTileFinished = [this](const RenderTile& tile) {
+                _viewportPreview->markDirty(tile.x0, tile.y0, tile.x1, tile.y1);
+            };
+            _progressive.onResize = [this](int width, int height) {
+                _viewportPreview->resize(width, height);
+            };
 
             _iconGrid = loadIcon("assets/textures/grid.png");
             _iconTranslate = loadIcon("assets/textures/translate.png");
@@ -112,9 +131,25 @@ class Application {
             glDeleteRenderbuffers(1, &_RBO);
 
             _raytraceInProgress = false;
+            _sequenceRenderer.cancel();
+            _streamingRenderer.cancel();
+#ifndef _WIN32
+            _coordinator.cancel();
+#endif
+            for (const auto& entry : _renders) {
+                if (entry->job)
+                    entry->job->cancel();
+            }
 
             if (_raytraceThread.joinable())
                 _raytraceThread.join();
+            for (const auto& entry : _renders) {
+                if (entry->job)
+                    entry->job->result().wait();
+            }
+
+            _progressive.stop();
+            glDeleteFramebuffers(1, &_viewportPreviewFBO);
 
             ImGui_ImplOpenGL3_Shutdown();
             ImGui_ImplGlfw_Shutdown();
@@ -136,26 +171,30 @@ class Application {
                 _scene->update(deltaTime, _moveVector, _lookDelta, _isRightButtonDown);
                 _lookDelta = {0.0f, 0.0f};
 
-                glBindFramebuffer(GL_FRAMEBUFFER, _MSAAFBO);
+                if (_pathTracedViewport) {
+                    renderPathTracedViewport();
+                } else {
+                    glBindFramebuffer(GL_FRAMEBUFFER, _MSAAFBO);
 
-                glViewport(0, 0, (int)_viewportSize.x, (int)_viewportSize.y);
-                glm::vec3 color = _scene->getSkyboxColor();
-                glm::vec3 gammaColor = glm::pow(color, glm::vec3(1.0f / 2.2f));
-                glClearColor(gammaColor.r, gammaColor.g, gammaColor.b, 1.0f);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+                    glViewport(0, 0, (int)_viewportSize.x, (int)_viewportSize.y);
+                    glm::vec3 color = _scene->getSkyboxColor();
+                    glm::vec3 gammaColor = glm::pow(color, glm::vec3(1.0f / 2.2f));
+                    glClearColor(gammaColor.r, gammaColor.g, gammaColor.b, 1.0f);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-                _scene->renderShadowPass((int)_viewportSize.x, (int)_viewportSize.y);
+                    _scene->renderShadowPass((int)_viewportSize.x, (int)_viewportSize.y);
 
-                glBindFramebuffer(GL_FRAMEBUFFER, _MSAAFBO);
-                glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+                    glBindFramebuffer(GL_FRAMEBUFFER, _MSAAFBO);
+                    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
 
-                _scene->render(deltaTime);
+                    _scene->render(deltaTime);
 
-                glBindFramebuffer(GL_READ_FRAMEBUFFER, _MSAAFBO);
-                glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _FBO);
-                glBlitFramebuffer(0, 0, _viewportSize.x, _viewportSize.y, 0, 0, _viewportSize.x, _viewportSize.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+                    glBindFramebuffer(GL_READ_FRAMEBUFFER, _MSAAFBO);
+                    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _FBO);
+                    glBlitFramebuffer(0, 0, _viewportSize.x, _viewportSize.y, 0, 0, _viewportSize.x, _viewportSize.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
 
-                glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+                }
 
                 glBindFramebuffer(GL_FRAMEBUFFER, _selectFBO);
 
@@ -166,16 +205,7 @@ class Application {
 
                 glBindFramebuffer(GL_FRAMEBUFFER, 0);
 
-                if (_scanlineUpdated) {
-                    std::lock_guard<std::mutex> lock(_previewMutex);
-                    int height = _renderWidth * 9 / 16;
-
-                    glBindTexture(GL_TEXTURE_2D, _renderId);
-                    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, _renderWidth, height, GL_RGB, GL_UNSIGNED_BYTE, _renderData.data());
-                    glBindTexture(GL_TEXTURE_2D, 0);
-
-                    _scanlineUpdated = false;
-                }
+                updateRenders();
 
                 renderUI();
                 
@@ -207,25 +237,75 @@ class Application {
 
         float _lastTime = 0.0f;
 
+        struct RenderEntry {
+            std::string name;
+            RayCamera camera;
+            SceneReplicas scene;
+            std::vector<unsigned char> display;
+            int width = 0;
+            int height = 0;
+            bool streaming = false;
+            bool distributed = false;
+            std::atomic<bool> cancelled = false;
+            RenderJobHandle job;
+            std::atomic<bool> running = true;
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            std::chrono::duration<double> duration{0.0};
+        };
+
         std::thread _raytraceThread;
         std::atomic<bool> _raytraceInProgress = false;
-        std::atomic<bool> _raytraceFinished = false;
-        unsigned int _renderId = 0;
-        std::vector<unsigned char> _renderData;
-        std::atomic<bool> _scanlineUpdated = false;
-        int _scanlineToUpload = -1;
+        RenderQueue& _renderQueue = RenderQueue::shared();
+        std::vector<std::shared_ptr<RenderEntry>> _renders;
+        std::shared_ptr<RenderEntry> _shownRender;
+        RenderEntry* _previewEntry = nullptr;
         std::mutex _previewMutex;
-        std::chrono::duration<double> _raytraceDuration{0.0};
+        int _renderPriority = 0;
+        int _renderCount = 0;
+        bool _pinWorkers = false;
+        bool _firstTouch = true;
+        bool _sceneReplicas = false;
+        Tonemapper _tonemapper;
+        DisplayMode _displayMode = DisplayMode::Beauty;
+        std::unique_ptr<RenderPreview> _preview;
+        std::unique_ptr<RenderPreview> _viewportPreview;
+        unsigned int _viewportPreviewFBO = 0;
+        ProgressiveRenderer _progressive;
+        bool _pathTracedViewport = false;
+        float _viewportScale = 0.5f;
 
         std::unique_ptr<Scene> _scene;
 
         bool _openSkyboxColorPopup = false;
         bool _openRenderPopup = false;
         bool _openCameraPopup = false;
+        bool _openSequencePopup = false;
 
         int _renderWidth = 120;
         int _samplesPerPixel = 100;
         int _maxDepth = 50;
+        Integrator _integrator = Integrator::Megakernel;
+        bool _sortRays = false;
+        bool _cacheOccluders = true;
+        LightSelection _lightSelection = LightSelection::All;
+        int _lightSamples = 1;
+        AOVSettings _aovs;
+        bool _checkpointEnabled = false;
+        float _checkpointInterval = 60.0f;
+        std::string _checkpointPath = "./render.ckpt";
+        bool _distributedRender = false;
+        int _localWorkers = 2;
+        char _workerAddress[256] = "unix:/tmp/radiance-render.sock";
+#ifndef _WIN32
+        RenderCoordinator _coordinator;
+#endif
+        AnimationSequence _sequence;
+        SequenceRenderer _sequenceRenderer;
+        int _sequenceFrame = 1;
+        char _sequencePattern[256] = "./frames/frame_####.png";
+        std::atomic<bool> _sequenceInProgress = false;
+        StreamingRenderer _streamingRenderer;
+        std::atomic<bool> _streamingInProgress = false;
 
         unsigned int _saveFBO = 0, _saveColor = 0;
 
@@ -236,6 +316,251 @@ class Application {
         bool _showAddContextMenu = false, _showDeleteContextMenu = false;
         ImVec2 _contextMenuPos;
 
+        bool _regionTool = false;
+        bool _selectingRegion = false;
+        glm::ivec2 _regionStart{0};
+        RenderTile _renderRegion = {0, 0, 0, 0};
+
+        std::shared_ptr<RenderEntry> createRender(const std::string& name, bool withDisplay = true) {
+            auto entry = std::make_shared<RenderEntry>();
+            entry->name = name + " " + std::to_string(++_renderCount);
+            entry->width = _renderWidth;
+            entry->height = _renderWidth * 9 / 16;
+            if (withDisplay)
+                entry->display.assign(size_t(entry->width) * entry->height * 3, 0);
+
+            RayCamera& camera = entry->camera;
+            Raytracer::configureCamera(camera, _scene->getCamera()->getTransform(), _scene->getSkyboxColor(), _renderWidth, _samplesPerPixel, _maxDepth);
+            camera.aovs() = _aovs;
+            camera.integrator() = _integrator;
+            camera.sortRays() = _sortRays;
+            camera.cacheOccluders() = _cacheOccluders;
+            camera.lightSelection() = _lightSelection;
+            camera.lightSamples() = _lightSamples;
+            camera.tonemapper() = _tonemapper;
+            camera.displayMode() = _displayMode;
+            camera.firstTouch() = _firstTouch;
+            camera.checkpointInterval() = 0.0f;
+            camera.sceneHash() = Raytracer::sceneHash(_scene->getEntities(), _scene->getSkyboxColor());
+
+            if (withDisplay) {
+                camera.imageDataBuffer = entry->display.data();
+                camera.onTileFinished = [this, target = entry.get()](const RenderTile& tile) {
+                    std::lock_guard<std::mutex> lock(_previewMutex);
+                    if (_previewEntry == target)
+                        _preview->markDirty(tile.x0, tile.y0, tile.x1, tile.y1);
+                };
+            }
+
+            _renders.push_back(entry);
+            showRender(entry);
+            return entry;
+        }
+
+        void showRender(const std::shared_ptr<RenderEntry>& entry) {
+            std::lock_guard<std::mutex> lock(_previewMutex);
+            _shownRender = entry;
+            _previewEntry = entry.get();
+            if (entry && !entry->display.empty())
+                _preview->resize(entry->width, entry->height);
+        }
+
+        void finishRender(RenderEntry& entry) {
+            entry.duration = std::chrono::steady_clock::now() - entry.start;
+            entry.running = false;
+
+            std::lock_guard<std::mutex> lock(_previewMutex);
+            if (_previewEntry == &entry)
+                _preview->markAllDirty();
+        }
+
+        void updateRenders() {
+            for (const auto& entry : _renders) {
+                if (entry->running && entry->job && entry->job->done()) {
+                    if (entry->camera.resumeFailed())
+                        std::cerr << "Checkpoint " << entry->camera.checkpointPath() << " does not match this render; it was left untouched" << std::endl;
+                    entry->camera.stats().writeJson("render_stats.json");
+                    finishRender(*entry);
+                }
+            }
+
+            if (_shownRender && !_shownRender->display.empty())
+                _preview->upload(_shownRender->display.data());
+        }
+
+        bool shownRendering() const {
+            return _shownRender && _shownRender->running;
+        }
+
+        std::string renderStatus(const RenderEntry& entry) const {
+            if (entry.camera.resumeFailed() && !entry.running)
+                return "RESUME FAILED";
+            RenderJobState state = entry.cancelled ? RenderJobState::Cancelled : entry.job ? entry.job->state() : RenderJobState::Running;
+            if (state == RenderJobState::Queued || state == RenderJobState::Cancelled)
+                return renderJobStateNames[(int)state];
+            if (entry.streaming && entry.running)
+                return "RENDERING BAND " + std::to_string(_streamingRenderer.currentBand() + 1);
+            return entry.running ? "RENDERING" : "COMPLETED";
+        }
+
+        void startRaytrace(bool resume, const RenderTile& region = {0, 0, 0, 0}) {
+            bool reuse = !region.empty() && _shownRender && !_shownRender->running && _shownRender->width == _renderWidth && !_shownRender->display.empty();
+            std::shared_ptr<RenderEntry> entry = reuse ? _shownRender : createRender(region.empty() ? "Render" : "Region");
+
+            RayCamera& camera = entry->camera;
+            if (reuse) {
+                Raytracer::configureCamera(camera, _scene->getCamera()->getTransform(), _scene->getSkyboxColor(), _renderWidth, _samplesPerPixel, _maxDepth);
+                camera.aovs() = _aovs;
+                camera.integrator() = _integrator;
+                camera.sortRays() = _sortRays;
+                camera.cacheOccluders() = _cacheOccluders;
+                camera.lightSelection() = _lightSelection;
+                camera.lightSamples() = _lightSamples;
+                camera.sceneHash() = Raytracer::sceneHash(_scene->getEntities(), _scene->getSkyboxColor());
+                entry->start = std::chrono::steady_clock::now();
+                entry->running = true;
+                entry->distributed = false;
+                entry->cancelled = false;
+            }
+
+            camera.region() = region;
+            camera.checkpointPath() = _checkpointPath;
+            camera.checkpointInterval() = _checkpointEnabled || resume ? _checkpointInterval : 0.0f;
+            camera.resume() = resume;
+
+            SceneDescription description = Raytracer::describeScene(_scene->getEntities(), _scene->getSkyboxColor());
+#ifndef _WIN32
+            if (_distributedRender) {
+                startDistributedRender(entry, std::move(description));
+                return;
+            }
+#endif
+            entry->scene.resize(_sceneReplicas ? _renderQueue.nodeCount() : 1);
+            entry->job = camera.submit(_renderQueue, entry->scene.views(), _renderPriority, [target = entry.get(), description = std::move(description)]() {
+                target->scene.build(description);
+            });
+        }
+
+#ifndef _WIN32
+        void startDistributedRender(std::shared_ptr<RenderEntry> entry, SceneDescription description) {
+            if (_raytraceThread.joinable())
+                _raytraceThread.join();
+
+            _raytraceInProgress = true;
+            entry->job = nullptr;
+            entry->distributed = true;
+            entry->cancelled = false;
+
+            _raytraceThread = std::thread([this, entry, description = std::move(description)]() {
+                try {
+                    _coordinator.listen(_workerAddress);
+                    _coordinator.spawnLocalWorkers(_localWorkers, "./radiance-worker");
+                    entry->cancelled = !_coordinator.render(entry->camera, description);
+                } catch (const std::exception& e) {
+                    std::cerr << "Distributed render failed: " << e.what() << std::endl;
+                }
+
+                entry->camera.stats().writeJson("render_stats.json");
+                finishRender(*entry);
+                _raytraceInProgress = false;
+            });
+        }
+#endif
+
+        void startSequence() {
+            if (_raytraceThread.joinable())
+                _raytraceThread.join();
+
+            _raytraceInProgress = true;
+            _sequenceInProgress = true;
+            std::shared_ptr<RenderEntry> entry = createRender("Sequence");
+
+            _raytraceThread = std::thread([this, entry, sequence = _sequence, pattern = std::string(_sequencePattern)]() {
+                if (!_sequenceRenderer.render(_scene->getEntities(), _scene->getSkyboxColor(), sequence, entry->camera, pattern))
+                    std::cerr << "Sequence render did not finish writing " << pattern << std::endl;
+
+                finishRender(*entry);
+                _sequenceInProgress = false;
+                _raytraceInProgress = false;
+            });
+        }
+
+        void startStreamingRender(const std::string& path) {
+            if (_raytraceThread.joinable())
+                _raytraceThread.join();
+
+            _raytraceInProgress = true;
+            _streamingInProgress = true;
+            std::shared_ptr<RenderEntry> entry = createRender("Disk", false);
+            entry->streaming = true;
+
+            _raytraceThread = std::thread([this, entry, path]() {
+                if (!_streamingRenderer.render(_scene->getEntities(), _scene->getSkyboxColor(), entry->camera, path))
+                    std::cerr << "Failed to write " << path << std::endl;
+
+                finishRender(*entry);
+                _streamingInProgress = false;
+                _raytraceInProgress = false;
+            });
+        }
+
+        void previewSequenceFrame(int frame) {
+            for (const auto& [id, track] : _sequence.tracks()) {
+                auto entity = _scene->getEntities().find(id);
+                if (entity == _scene->getEntities().end())
+                    continue;
+
+                entity->second->getTransform() = track.evaluate(float(frame));
+                if (Camera* camera = dynamic_cast<Camera*>(entity->second.get()))
+                    camera->recalculate();
+            }
+        }
+
+        void keyTurntable() {
+            Camera* camera = _scene->getCamera();
+            glm::vec3 position = camera->getTransform().position;
+            float radius = glm::length(glm::vec2(position.x, position.z));
+            float height = position.y;
+            float distance = glm::length(position);
+            if (radius <= 0.0f || distance <= 0.0f)
+                return;
+
+            int start = _sequence.startFrame();
+            int count = _sequence.endFrame() - start + 1;
+            float startAngle = atan2f(position.z, position.x);
+
+            for (int frame = start; frame <= _sequence.endFrame(); frame++) {
+                float angle = startAngle + 2.0f * glm::pi<float>() * float(frame - start) / float(count);
+
+                Transform transform = camera->getTransform();
+                transform.position = glm::vec3(radius * cosf(angle), height, radius * sinf(angle));
+                transform.rotation.x = glm::degrees(asinf(-height / distance));
+                transform.rotation.y = glm::degrees(atan2f(-transform.position.z, -transform.position.x));
+                _sequence.setKey(camera->getId(), frame, transform);
+            }
+        }
+
+        void renderPathTracedViewport() {
+            if (_raytraceInProgress || _renderQueue.pending() > 0) {
+                _progressive.stop();
+            } else if (_viewportSize.x >= 1.0f && _viewportSize.y >= 1.0f) {
+                int width = std::max(int(_viewportSize.x * _viewportScale), 1);
+                Camera* camera = _scene->getCamera();
+                _progressive.update(_scene->getEntities(), _scene->getSkyboxColor(), camera->getTransform(), width, _viewportSize.x / _viewportSize.y);
+            }
+
+            if (_progressive.width() == 0)
+                return;
+
+            _viewportPreview->upload(_progressive.display());
+
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, _viewportPreviewFBO);
+            glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _FBO);
+            glBlitFramebuffer(0, 0, _progressive.width(), _progressive.height(), 0, 0, _viewportSize.x, _viewportSize.y, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
         void initializeFramebuffer() {
             glGenFramebuffers(1, &_FBO);
             glBindFramebuffer(GL_FRAMEBUFFER, _FBO);
@@ -479,6 +804,11 @@ class Application {
             _viewportPos = ImGui::GetItemRectMin();
             _isViewportHovered = ImGui::IsItemHovered();
 
+            if (_pathTracedViewport) {
+                std::string samples = std::to_string(_progressive.samples()) + " spp";
+                ImGui::GetWindowDrawList()->AddText(ImVec2(_viewportPos.x + 12, _viewportPos.y + 12), IM_COL32(255, 255, 255, 255), samples.c_str());
+            }
+
             ImVec2 imageMin = ImGui::GetItemRectMin();
             ImVec2 imageMax = ImGui::GetItemRectMax();
 
@@ -733,16 +1063,14 @@ class Application {
             
             if (ImGui::BeginTable("table", 2, ImGuiTableFlags_SizingStretchSame)) {
                 ImGui::TableNextColumn();
-                std::string status = _raytraceInProgress ? "RENDERING" : "COMPLETED";
-                if (_renderData.empty() && !_raytraceInProgress)
-                    status = "-";
+                std::string status = _shownRender ? renderStatus(*_shownRender) : "-";
                 ImGui::Text("Status: %s", status.c_str());
 
                 ImGui::TableNextColumn();
-                if (_raytraceInProgress) {
-                    int scanline = RayCamera::currentScanline.load();
-                    int scansize = RayCamera::scanlineSize.load();
-                    float progress = 1.0f - (float)scanline / (float)(scansize - 1);
+                if (shownRendering()) {
+                    int finished = _shownRender->camera.finishedTiles();
+                    int count = _shownRender->camera.tileCount();
+                    float progress = count > 0 ? (float)finished / (float)count : 0.0f;
                     ImGui::Text("Progress: ");
                     ImGui::SameLine();
                     float barHeight = ImGui::GetTextLineHeight();
@@ -752,10 +1080,11 @@ class Application {
                     ImGui::PopStyleColor();
                 } else {
                     ImGui::SetCursorPosX(ImGui::GetContentRegionMax().x - ImGui::CalcTextSize("Time elapsed: 00:00:00").x);
-                    if (!_renderData.empty()) {
-                        int hours   = static_cast<int>(_raytraceDuration.count()) / 3600;
-                        int minutes = (static_cast<int>(_raytraceDuration.count()) % 3600) / 60;
-                        int seconds = static_cast<int>(_raytraceDuration.count()) % 60;
+                    if (_shownRender) {
+                        int elapsed = static_cast<int>(_shownRender->duration.count());
+                        int hours   = elapsed / 3600;
+                        int minutes = (elapsed % 3600) / 60;
+                        int seconds = elapsed % 60;
                         ImGui::Text("Time elapsed: %02d:%02d:%02d", hours, minutes, seconds);
                     } else {
                         ImGui::Text("Time elapsed: --:--:--");
@@ -767,8 +1096,9 @@ class Application {
 
             ImGui::EndChild();
 
-            ImGui::BeginChild("Render view", ImVec2(0, 0), true, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
-            if (_renderId) {
+            float viewWidth = ImGui::GetContentRegionAvail().x - 260.0f;
+            ImGui::BeginChild("Render view", ImVec2(viewWidth, 0), true, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
+            if (_preview->getTexture()) {
                 ImVec2 avail = ImGui::GetContentRegionAvail();
 
                 float aspect = 16.0f / 9.0f;
@@ -785,11 +1115,140 @@ class Application {
                 ImGui::SetCursorPosX(ImGui::GetCursorPosX() + padX);
                 ImGui::SetCursorPosY(ImGui::GetCursorPosY() + padY);
 
-                ImGui::Image((ImTextureID)(intptr_t)_renderId, ImVec2(width, height), ImVec2(0, 1), ImVec2(1, 0));
+                ImGui::Image((ImTextureID)(intptr_t)_preview->getTexture(), ImVec2(width, height), ImVec2(0, 1), ImVec2(1, 0));
+                selectRenderRegion(ImGui::GetItemRectMin(), ImGui::GetItemRectMax());
+            }
+            ImGui::EndChild();
+
+            ImGui::SameLine();
+
+            ImGui::BeginChild("Render statistics", ImVec2(0, 0), true, ImGuiWindowFlags_NoResize | ImGuiWindowFlags_NoCollapse);
+            ImGui::TextDisabled("Region");
+            ImGui::Separator();
+
+            ImGui::Checkbox("Drag to select region", &_regionTool);
+            if (_renderRegion.empty())
+                ImGui::TextDisabled("Full frame");
+            else
+                ImGui::Text("%d, %d - %d, %d", _renderRegion.x0, _renderRegion.y0, _renderRegion.x1, _renderRegion.y1);
+
+            ImGui::BeginDisabled(_renderRegion.empty() || shownRendering());
+            if (ImGui::Button("Render region"))
+                startRaytrace(false, _renderRegion);
+            ImGui::SameLine();
+            if (ImGui::Button("Clear region"))
+                _renderRegion = {0, 0, 0, 0};
+            ImGui::EndDisabled();
+
+            ImGui::Spacing();
+            ImGui::TextDisabled("Queue");
+            ImGui::Separator();
+
+            ImGui::InputInt("Priority", &_renderPriority);
+            std::shared_ptr<RenderEntry> selectedRender;
+            for (size_t i = 0; i < _renders.size(); i++) {
+                const std::shared_ptr<RenderEntry>& entry = _renders[i];
+                ImGui::PushID((int)i);
+
+                std::string label = entry->name + "  " + renderStatus(*entry);
+                if (entry->running && entry->camera.tileCount() > 0)
+                    label += " " + std::to_string(entry->camera.finishedTiles() * 100 / entry->camera.tileCount()) + "%";
+                if (ImGui::Selectable(label.c_str(), entry == _shownRender))
+                    selectedRender = entry;
+
+                if (entry->job && !entry->job->done()) {
+                    int priority = entry->job->priority();
+                    ImGui::SetNextItemWidth(90.0f);
+                    if (ImGui::InputInt("##priority", &priority))
+                        entry->job->setPriority(priority);
+                    ImGui::SameLine();
+                    if (ImGui::SmallButton("Cancel"))
+                        entry->job->cancel();
+                }
+#ifndef _WIN32
+                if (entry->distributed && entry->running) {
+                    if (ImGui::SmallButton("Cancel"))
+                        _coordinator.cancel();
+                }
+#endif
+
+                ImGui::PopID();
+            }
+            if (selectedRender)
+                showRender(selectedRender);
+
+            if (ImGui::Button("Clear finished")) {
+                _renders.erase(std::remove_if(_renders.begin(), _renders.end(), [this](const std::shared_ptr<RenderEntry>& entry) {
+                    return !entry->running && entry != _shownRender;
+                }), _renders.end());
+            }
+
+            ImGui::Spacing();
+            ImGui::TextDisabled("Statistics");
+            ImGui::Separator();
+
+            if (_shownRender && ImGui::BeginTable("stats", 2, ImGuiTableFlags_SizingStretchProp)) {
+                RenderCounters stats = _shownRender->camera.stats();
+
+                auto row = [](const char* name, const char* format, auto value) {
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(name);
+                    ImGui::TableNextColumn();
+                    ImGui::Text(format, value);
+                };
+
+                row("Camera rays", "%llu", (unsigned long long)stats[Counter::CameraRays]);
+                row("Scatter rays", "%llu", (unsigned long long)stats[Counter::ScatterRays]);
+                row("Shadow rays", "%llu", (unsigned long long)stats[Counter::ShadowRays]);
+                row("BVH nodes", "%llu", (unsigned long long)stats[Counter::BVHNodes]);
+                row("Triangles", "%llu", (unsigned long long)stats[Counter::Triangles]);
+                row("SDF steps", "%llu", (unsigned long long)stats[Counter::SDFSteps]);
+                row("Path length", "%.2f", stats.averagePathLength());
+                row("Samples/pixel", "%.2f", stats.averageSamplesPerPixel());
+                row("Mrays/s", "%.2f", stats.megaRaysPerSecond());
+                row("Seconds", "%.2f", stats.seconds);
+
+                ImGui::EndTable();
             }
             ImGui::EndChild();
         }
 
+        void selectRenderRegion(const ImVec2& imageMin, const ImVec2& imageMax) {
+            int renderHeight = _renderWidth * 9 / 16;
+            ImVec2 size(imageMax.x - imageMin.x, imageMax.y - imageMin.y);
+
+            auto toPixel = [&](const ImVec2& point) {
+                float u = glm::clamp((point.x - imageMin.x) / size.x, 0.0f, 1.0f);
+                float v = glm::clamp((imageMax.y - point.y) / size.y, 0.0f, 1.0f);
+                return glm::ivec2(int(u * _renderWidth + 0.5f), int(v * renderHeight + 0.5f));
+            };
+
+            if (_regionTool && !shownRendering() && ImGui::IsItemHovered() && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
+                _selectingRegion = true;
+                _regionStart = toPixel(ImGui::GetMousePos());
+            }
+
+            if (_selectingRegion) {
+                glm::ivec2 end = toPixel(ImGui::GetMousePos());
+                glm::ivec2 lo = glm::min(_regionStart, end);
+                glm::ivec2 hi = glm::max(_regionStart, end);
+                _renderRegion = {lo.x, lo.y, hi.x, hi.y};
+
+                if (!ImGui::IsMouseDown(ImGuiMouseButton_Left)) {
+                    _selectingRegion = false;
+                    if (_renderRegion.width() < 2 || _renderRegion.height() < 2)
+                        _renderRegion = {0, 0, 0, 0};
+                }
+            }
+
+            if (_renderRegion.empty() || _renderWidth <= 0 || renderHeight <= 0)
+                return;
+
+            ImVec2 regionMin(imageMin.x + size.x * _renderRegion.x0 / _renderWidth, imageMax.y - size.y * _renderRegion.y1 / renderHeight);
+            ImVec2 regionMax(imageMin.x + size.x * _renderRegion.x1 / _renderWidth, imageMax.y - size.y * _renderRegion.y0 / renderHeight);
+            ImGui::GetWindowDrawList()->AddRect(regionMin, regionMax, IM_COL32(255, 200, 0, 255), 0.0f, 0, 2.0f);
+        }
+
         void renderUI() {
             ImGui_ImplOpenGL3_NewFrame();
             ImGui_ImplGlfw_NewFrame();
@@ -865,56 +1324,56 @@ class Application {
                     ImGui::EndMenu();
                 }
                 if (ImGui::BeginMenu("Render")) {
-                    if (ImGui::MenuItem("Render scene", nullptr, nullptr, !_raytraceInProgress)) {
-                        if (_raytraceThread.joinable())
-                            _raytraceThread.join();
-
-                        _raytraceInProgress = true;
-                        _raytraceFinished = false;
-
-                        int height = _renderWidth * 9 / 16;
-                        _renderData.resize(_renderWidth * height * 3);
-
-                        _scanlineUpdated = false;
-                        _scanlineToUpload = -1;
-
-                        std::fill(_renderData.begin(), _renderData.end(), 0);
-
-                        glBindTexture(GL_TEXTURE_2D, _renderId);
-                        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, _renderWidth, height, 0, GL_RGB, GL_UNSIGNED_BYTE, _renderData.data());
-                        glBindTexture(GL_TEXTURE_2D, 0);
-
-                        Raytracer::camera.imageDataBuffer = _renderData.data();
-                        Raytracer::camera.onScanlineFinished = [this](int j) {
-                            _scanlineUpdated = true;
-                        };
-
-                        _raytraceThread = std::thread([this]() {
-                            auto start = std::chrono::high_resolution_clock::now();
-
-                            Raytracer::raytrace(_scene->getEntities(), _scene->getSkyboxColor(), _renderWidth, _samplesPerPixel, _maxDepth);
-                            
-                            auto end = std::chrono::high_resolution_clock::now();
-                            _raytraceDuration = end - start;
-
-                            _raytraceInProgress = false;
-                            _raytraceFinished = true;
-                            _scanlineUpdated = true;
-                        });
+                    bool canRender = !_distributedRender || !_raytraceInProgress;
+                    if (ImGui::MenuItem("Render scene", nullptr, nullptr, canRender))
+                        startRaytrace(false);
+                    if (ImGui::MenuItem("Render to disk", nullptr, nullptr, !_raytraceInProgress)) {
+                        const char* filters[] = { "*.exr", "*.pfm" };
+                        const char* path = tinyfd_saveFileDialog("Render to disk", "./render.exr", 2, filters, NULL);
+                        if (path)
+                            startStreamingRender(path);
+                    }
+                    if (ImGui::MenuItem("Resume from checkpoint", nullptr, nullptr, canRender)) {
+                        const char* filters[] = { "*.ckpt" };
+                        const char* path = tinyfd_openFileDialog("Resume from checkpoint", _checkpointPath.c_str(), 1, filters, NULL, 0);
+                        if (path) {
+                            _checkpointPath = path;
+                            startRaytrace(true);
+                        }
+                    }
+                    bool hasRender = _shownRender && !_shownRender->display.empty();
+                    if (ImGui::MenuItem("Save current render", nullptr, false, hasRender && !shownRendering())) {
+                        const char* filters[] = { "*.png", "*.hdr", "*.pfm" };
+                        const char* path = tinyfd_saveFileDialog("Save current render", "./render.png", 3, filters, NULL);
+                        if (path) {
+                            std::filesystem::path extension = std::filesystem::path(path).extension();
+                            if (extension == ".hdr") {
+                                RenderOutput::saveHDR(path, _shownRender->camera.buffers(), _shownRender->camera.denoise());
+                            } else if (extension == ".pfm") {
+                                RenderOutput::savePFM(path, _shownRender->camera.buffers(), _shownRender->camera.denoise());
+                            } else {
+                                stbi_flip_vertically_on_write(true);
+                                stbi_write_png(path, _shownRender->width, _shownRender->height, 3, _shownRender->display.data(), _shownRender->width * 3);
+                            }
+                        }
                     }
-                    bool hasRender = !_renderData.empty();
-                    if (ImGui::MenuItem("Save current render", nullptr, false, hasRender)) {
-                        const char* filters[] = { "*.png" };
-                        const char* path = tinyfd_saveFileDialog("Save current render", "./render.png", 1, filters, NULL);
+                    if (ImGui::MenuItem("Save render passes", nullptr, false, hasRender && !shownRendering())) {
+                        const char* filters[] = { "*.exr" };
+                        const char* path = tinyfd_saveFileDialog("Save render passes", "./render.exr", 1, filters, NULL);
                         if (path) {
-                            int height = _renderWidth * 9 / 16;
-                            stbi_flip_vertically_on_write(true);
-                            stbi_write_png(path, _renderWidth, height, 3, _renderData.data(), _renderWidth * 3);
+                            RenderOutput::saveLayers(path, _shownRender->camera.buffers(), _shownRender->camera.denoise());
                         }
                     }
+                    if (ImGui::MenuItem("Path traced viewport", nullptr, &_pathTracedViewport)) {
+                        if (!_pathTracedViewport)
+                            _progressive.stop();
+                    }
                     if (ImGui::MenuItem("Change render settings")) {
                         _openRenderPopup = true;
                     }
+                    if (ImGui::MenuItem("Animation sequence")) {
+                        _openSequencePopup = true;
+                    }
                     ImGui::EndMenu();
                 }
                 if (ImGui::BeginMenu("Debug")) {
@@ -1016,6 +1475,111 @@ class Application {
                 ImGui::InputInt("Samples per pixel", &_samplesPerPixel);
                 ImGui::InputInt("Max depth", &_maxDepth);
 
+                int integrator = (int)_integrator;
+                if (ImGui::Combo("Integrator", &integrator, integratorNames, (int)Integrator::END)) {
+                    _integrator = (Integrator)integrator;
+                    _progressive.integrator() = _integrator;
+                }
+                ImGui::BeginDisabled(_integrator != Integrator::Wavefront);
+                if (ImGui::Checkbox("Sort secondary rays", &_sortRays))
+                    _progressive.sortRays() = _sortRays;
+                if (ImGui::Checkbox("Cache shadow occluders", &_cacheOccluders))
+                    _progressive.cacheOccluders() = _cacheOccluders;
+                ImGui::EndDisabled();
+
+                int lightSelection = (int)_lightSelection;
+                if (ImGui::Combo("Light selection", &lightSelection, lightSelectionNames, (int)LightSelection::END)) {
+                    _lightSelection = (LightSelection)lightSelection;
+                    _progressive.lightSelection() = _lightSelection;
+                }
+                ImGui::BeginDisabled(_lightSelection == LightSelection::All || _lightSelection == LightSelection::Nearby);
+                if (ImGui::InputInt("Light samples", &_lightSamples)) {
+                    _lightSamples = std::max(_lightSamples, 1);
+                    _progressive.lightSamples() = _lightSamples;
+                }
+                ImGui::EndDisabled();
+
+                ImGui::Separator();
+                ImGui::TextDisabled("Render passes");
+                ImGui::Checkbox("Depth", &_aovs.depth);
+                ImGui::Checkbox("Normal", &_aovs.normal);
+                ImGui::Checkbox("Albedo", &_aovs.albedo);
+                ImGui::Checkbox("Object ID", &_aovs.objectId);
+                ImGui::Checkbox("Material ID", &_aovs.materialId);
+                ImGui::Checkbox("Sample count", &_aovs.sampleCount);
+                ImGui::Checkbox("Direct light", &_aovs.direct);
+                ImGui::Checkbox("Indirect light", &_aovs.indirect);
+                ImGui::Checkbox("Pixel cost", &_aovs.cost);
+
+                ImGui::Separator();
+                ImGui::TextDisabled("Checkpoints");
+                ImGui::Checkbox("Write checkpoints", &_checkpointEnabled);
+                ImGui::InputFloat("Interval (s)", &_checkpointInterval, 10.0f, 60.0f, "%.0f");
+                ImGui::TextWrapped("%s", _checkpointPath.c_str());
+                if (ImGui::Button("Checkpoint file...")) {
+                    const char* filters[] = { "*.ckpt" };
+                    const char* path = tinyfd_saveFileDialog("Checkpoint file", _checkpointPath.c_str(), 1, filters, NULL);
+                    if (path)
+                        _checkpointPath = path;
+                }
+
+                ImGui::Separator();
+                ImGui::TextDisabled("Threads");
+                ImGui::Text("%d workers, %d NUMA nodes", _renderQueue.threadCount(), _renderQueue.nodeCount());
+                if (ImGui::Checkbox("Pin workers to cores", &_pinWorkers))
+                    _pinWorkers = _renderQueue.setPinning(_pinWorkers) && _pinWorkers;
+                ImGui::Checkbox("First-touch buffers", &_firstTouch);
+                ImGui::Checkbox("Copy scene to each node", &_sceneReplicas);
+
+                ImGui::Separator();
+                ImGui::TextDisabled("Render to disk");
+                ImGui::InputInt("Tile rows per band", &_streamingRenderer.bandRows());
+                _streamingRenderer.bandRows() = std::max(_streamingRenderer.bandRows(), 1);
+
+#ifndef _WIN32
+                ImGui::Separator();
+                ImGui::TextDisabled("Distributed");
+                ImGui::BeginDisabled(_raytraceInProgress);
+                ImGui::Checkbox("Render on workers", &_distributedRender);
+                ImGui::InputInt("Local workers", &_localWorkers);
+                ImGui::InputText("Listen address", _workerAddress, sizeof(_workerAddress));
+                ImGui::EndDisabled();
+                _localWorkers = std::max(_localWorkers, 0);
+#endif
+
+                ImGui::Separator();
+                ImGui::TextDisabled("Viewport");
+                ImGui::SliderFloat("Resolution scale", &_viewportScale, 0.1f, 1.0f, "%.2f");
+                ImGui::InputInt("Viewport samples", &_progressive.maxSamples());
+                ImGui::InputInt("Viewport depth", &_progressive.maxDepth());
+
+                ImGui::Separator();
+                ImGui::TextDisabled("Display");
+                ImGui::BeginDisabled(shownRendering());
+
+                bool displayChanged = ImGui::SliderFloat("Exposure", &_tonemapper.exposure(), -8.0f, 8.0f, "%.2f EV");
+
+                int toneMapping = (int)_tonemapper.toneMapping();
+                if (ImGui::Combo("Tone mapping", &toneMapping, toneMappingNames, (int)ToneMapping::END)) {
+                    _tonemapper.toneMapping() = (ToneMapping)toneMapping;
+                    displayChanged = true;
+                }
+
+                int displayMode = (int)_displayMode;
+                if (ImGui::Combo("Display", &displayMode, displayModeNames, (int)DisplayMode::END)) {
+                    _displayMode = (DisplayMode)displayMode;
+                    displayChanged = true;
+                }
+
+                if (displayChanged && _shownRender && !_shownRender->display.empty()) {
+                    _shownRender->camera.tonemapper() = _tonemapper;
+                    _shownRender->camera.displayMode() = _displayMode;
+                    _shownRender->camera.updateDisplay();
+                    _preview->markAllDirty();
+                }
+
+                ImGui::EndDisabled();
+
                 ImGui::Separator();
                 if (ImGui::Button("Close", ImVec2(-1, 0))) {
                     _openRenderPopup = false;
@@ -1025,6 +1589,72 @@ class Application {
                 ImGui::EndPopup();
             }
 
+            if (_openSequencePopup) {
+                ImGui::OpenPopup("##Sequence popup");
+            }
+
+            if (ImGui::BeginPopup("##Sequence popup")) {
+                ImGui::TextDisabled("Animation Sequence");
+                ImGui::Separator();
+
+                ImGui::BeginDisabled(_raytraceInProgress);
+                ImGui::InputInt("Start frame", &_sequence.startFrame());
+                ImGui::InputInt("End frame", &_sequence.endFrame());
+                _sequence.endFrame() = std::max(_sequence.endFrame(), _sequence.startFrame());
+                _sequenceFrame = glm::clamp(_sequenceFrame, _sequence.startFrame(), _sequence.endFrame());
+
+                if (ImGui::SliderInt("Frame", &_sequenceFrame, _sequence.startFrame(), _sequence.endFrame()))
+                    previewSequenceFrame(_sequenceFrame);
+
+                Entity* selected = _scene->getSelectedEntity();
+                Camera* camera = _scene->getCamera();
+                const TransformTrack* selectedTrack = selected ? _sequence.track(selected->getId()) : nullptr;
+
+                ImGui::BeginDisabled(!selected);
+                if (ImGui::Button("Key selected"))
+                    _sequence.setKey(selected->getId(), _sequenceFrame, selected->getTransform());
+                ImGui::SameLine();
+                if (ImGui::Button("Delete key") && selectedTrack)
+                    _sequence.removeKey(selected->getId(), _sequenceFrame);
+                ImGui::EndDisabled();
+
+                ImGui::SameLine();
+                if (ImGui::Button("Key camera"))
+                    _sequence.setKey(camera->getId(), _sequenceFrame, camera->getTransform());
+
+                if (ImGui::Button("Turntable"))
+                    keyTurntable();
+                ImGui::SameLine();
+                if (ImGui::Button("Clear keys"))
+                    _sequence.clear();
+
+                ImGui::Text("%d animated entities", (int)_sequence.tracks().size());
+                if (selectedTrack)
+                    ImGui::Text("Selected: %d keys%s", (int)selectedTrack->keys().size(), selectedTrack->hasKey(_sequenceFrame) ? " (keyed here)" : "");
+
+                ImGui::Separator();
+                ImGui::InputText("Output", _sequencePattern, sizeof(_sequencePattern));
+                ImGui::TextDisabled("# is replaced by the frame number");
+
+                if (ImGui::Button("Render sequence", ImVec2(-1, 0)))
+                    startSequence();
+                ImGui::EndDisabled();
+
+                if (_sequenceInProgress) {
+                    ImGui::Text("Rendering frame %d of %d", _sequenceRenderer.currentFrame(), _sequence.endFrame());
+                    if (ImGui::Button("Cancel", ImVec2(-1, 0)))
+                        _sequenceRenderer.cancel();
+                }
+
+                ImGui::Separator();
+                if (ImGui::Button("Close", ImVec2(-1, 0))) {
+                    _openSequencePopup = false;
+                    ImGui::CloseCurrentPopup();
+                }
+
+                ImGui::EndPopup();
+            }
+
             if (_showAddContextMenu) {
                 ImGui::OpenPopup("##ViewportAddMenu");
                 _showAddContextMenu = false;
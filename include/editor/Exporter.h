@@ -111,10 +111,10 @@ class Exporter {
 
                     auto& buffer = model.buffers[0];
 
-                    auto verts = mesh->getVertices();
-                    auto inds = mesh->getIndices();
+                    std::vector<float> verts;
+                    std::vector<unsigned int> inds;
 
-                    weldVertices(verts, inds);
+                    weldVertices(mesh->getVertices(), mesh->getIndices(), verts, inds);
                     fixWindingOrder(inds, verts);
 
                     const size_t vertexCount = verts.size() / 6;
@@ -315,10 +315,11 @@ class Exporter {
             }
         }
 
-        static void weldVertices(std::vector<float>& verts, std::vector<unsigned int>& inds) {
+        static void weldVertices(Span<const float> verts, Span<const unsigned int> inds, std::vector<float>& newVerts, std::vector<unsigned int>& newInds) {
             const int stride = 6;
-            std::vector<float> newVerts;
-            std::vector<unsigned int> newInds;
+            newVerts.clear();
+            newInds.clear();
+            newInds.reserve(inds.size());
             std::map<std::array<float, 6>, unsigned int> uniqueMap;
 
             for (size_t i = 0; i < inds.size(); i++) {
@@ -337,9 +338,6 @@ class Exporter {
                 }
                 newInds.push_back(uniqueMap[key]);
             }
-
-            verts = std::move(newVerts);
-            inds = std::move(newInds);
         }
 };
 
@@ -0,0 +1,165 @@
+#ifndef RENDERPREVIEW_H
+#define RENDERPREVIEW_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+class RenderPreview {
+    public:
+        RenderPreview() {
+            glGenTextures(1, &_texture);
+            glBindTexture(GL_TEXTURE_2D, _texture);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            glGenBuffers(2, _pixelBuffers);
+        }
+
+        ~RenderPreview() {
+            glDeleteBuffers(2, _pixelBuffers);
+            glDeleteTextures(1, &_texture);
+        }
+
+        void resize(int width, int height) {
+            _width = width;
+            _height = height;
+            _cellsX = (width + _cellSize - 1) / _cellSize;
+            _cellsY = (height + _cellSize - 1) / _cellSize;
+            _wordCount = (_cellsX * _cellsY + 63) / 64;
+
+            _dirty = std::make_unique<std::atomic<uint64_t>[]>(_wordCount);
+            for (int i = 0; i < _wordCount; i++)
+                _dirty[i].store(0);
+
+            glBindTexture(GL_TEXTURE_2D, _texture);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
+            glBindTexture(GL_TEXTURE_2D, 0);
+
+            for (unsigned int buffer : _pixelBuffers) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+                glBufferData(GL_PIXEL_UNPACK_BUFFER, size_t(width) * height * 3, nullptr, GL_STREAM_DRAW);
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+            markAllDirty();
+        }
+
+        void markDirty(int x0, int y0, int x1, int y1) {
+            if (!_dirty || x1 <= x0 || y1 <= y0)
+                return;
+
+            for (int cy = y0 / _cellSize; cy <= (y1 - 1) / _cellSize; cy++) {
+                for (int cx = x0 / _cellSize; cx <= (x1 - 1) / _cellSize; cx++) {
+                    int cell = cy * _cellsX + cx;
+                    _dirty[cell / 64].fetch_or(uint64_t(1) << (cell % 64), std::memory_order_release);
+                }
+            }
+        }
+
+        void markAllDirty() {
+            markDirty(0, 0, _width, _height);
+        }
+
+        void upload(const unsigned char* image) {
+            if (!_dirty)
+                return;
+
+            collectRegions();
+            if (_regions.empty())
+                return;
+
+            size_t bytes = 0;
+            for (const glm::ivec4& region : _regions)
+                bytes += size_t(region.z) * region.w * 3;
+
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, _pixelBuffers[_nextBuffer]);
+            _nextBuffer ^= 1;
+
+            unsigned char* mapped = static_cast<unsigned char*>(glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bytes, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+            if (!mapped) {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                for (const glm::ivec4& region : _regions)
+                    markDirty(region.x, region.y, region.x + region.z, region.y + region.w);
+                return;
+            }
+
+            size_t offset = 0;
+            for (const glm::ivec4& region : _regions) {
+                size_t rowBytes = size_t(region.z) * 3;
+                for (int y = region.y; y < region.y + region.w; y++) {
+                    std::memcpy(mapped + offset, image + (size_t(y) * _width + region.x) * 3, rowBytes);
+                    offset += rowBytes;
+                }
+            }
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+            glBindTexture(GL_TEXTURE_2D, _texture);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+            offset = 0;
+            for (const glm::ivec4& region : _regions) {
+                glTexSubImage2D(GL_TEXTURE_2D, 0, region.x, region.y, region.z, region.w, GL_RGB, GL_UNSIGNED_BYTE, reinterpret_cast<const void*>(offset));
+                offset += size_t(region.z) * region.w * 3;
+            }
+
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        }
+
+        unsigned int getTexture() const { return _texture; }
+        int getWidth() const { return _width; }
+        int getHeight() const { return _height; }
+    private:
+        const int _cellSize = 32;
+
+        unsigned int _texture = 0;
+        unsigned int _pixelBuffers[2] = {0, 0};
+        int _nextBuffer = 0;
+
+        int _width = 0;
+        int _height = 0;
+        int _cellsX = 0;
+        int _cellsY = 0;
+        int _wordCount = 0;
+
+        std::unique_ptr<std::atomic<uint64_t>[]> _dirty;
+        std::vector<uint64_t> _cells;
+        std::vector<glm::ivec4> _regions;
+
+        void collectRegions() {
+            _cells.resize(_wordCount);
+            for (int i = 0; i < _wordCount; i++)
+                _cells[i] = _dirty[i].exchange(0, std::memory_order_acquire);
+
+            _regions.clear();
+            for (int cy = 0; cy < _cellsY; cy++) {
+                int runStart = -1;
+                for (int cx = 0; cx <= _cellsX; cx++) {
+                    int cell = cy * _cellsX + cx;
+                    bool dirty = cx < _cellsX && (_cells[cell / 64] >> (cell % 64)) & 1;
+
+                    if (dirty && runStart < 0) {
+                        runStart = cx;
+                    } else if (!dirty && runStart >= 0) {
+                        int x0 = runStart * _cellSize;
+                        int y0 = cy * _cellSize;
+                        int x1 = std::min(cx * _cellSize, _width);
+                        int y1 = std::min(y0 + _cellSize, _height);
+                        _regions.push_back({x0, y0, x1 - x0, y1 - y0});
+                        runStart = -1;
+                    }
+                }
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef GEOMETRY_H
+#define GEOMETRY_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <type_traits>
+
+template<typename T>
+class Span {
+    public:
+        Span() = default;
+        Span(T* data, size_t size) : _data(data), _size(size) {}
+        template<typename U>
+        Span(const std::vector<U>& values) : _data(values.data()), _size(values.size()) {}
+
+        T* data() const { return _data; }
+        size_t size() const { return _size; }
+        bool empty() const { return _size == 0; }
+        T* begin() const { return _data; }
+        T* end() const { return _data + _size; }
+        T& operator[](size_t i) const { return _data[i]; }
+
+        std::vector<std::remove_const_t<T>> toVector() const { return {begin(), end()}; }
+    private:
+        T* _data = nullptr;
+        size_t _size = 0;
+};
+
+class Geometry {
+    public:
+        static constexpr int FloatsPerVertex = 6;
+
+        Geometry(std::vector<float> vertices, std::vector<unsigned int> indices)
+            : _vertices(std::move(vertices)), _indices(std::move(indices)) {}
+
+        static std::shared_ptr<const Geometry> create(std::vector<float> vertices, std::vector<unsigned int> indices) {
+            return std::make_shared<const Geometry>(std::move(vertices), std::move(indices));
+        }
+
+        Span<const float> vertices() const { return _vertices; }
+        Span<const unsigned int> indices() const { return _indices; }
+        size_t vertexCount() const { return _vertices.size() / FloatsPerVertex; }
+    private:
+        const std::vector<float> _vertices;
+        const std::vector<unsigned int> _indices;
+};
+
+using GeometryHandle = std::shared_ptr<const Geometry>;
+
+#endif
@@ -19,6 +19,7 @@
 #include <glm/gtx/euler_angles.hpp>
 
 #include "../Entity.h"
+#include "Geometry.h"
 #include "../../Shader.h"
 
 struct Material {
@@ -57,28 +58,35 @@ class Mesh : public Entity {
         }
 
         void renderGeometry() {
+            if (!_geometry) return;
+
             glBindVertexArray(_VAO);
-            if (!_indices.empty()) {
-                glDrawElements(GL_TRIANGLES, _indices.size(), GL_UNSIGNED_INT, 0);
+            if (!_geometry->indices().empty()) {
+                glDrawElements(GL_TRIANGLES, _geometry->indices().size(), GL_UNSIGNED_INT, 0);
             } else {
-                glDrawArrays(GL_TRIANGLES, 0, _vertices.size() / _floatsPerVert);
+                glDrawArrays(GL_TRIANGLES, 0, _geometry->vertices().size() / _floatsPerVert);
             }
             glBindVertexArray(0);
         }
 
         virtual void initializeCreate() override {
             generateMesh();
+            _geometry = Geometry::create(std::move(_vertices), std::move(_indices));
+            _vertices = {};
+            _indices = {};
             initializeBuffers();
         }
 
         Material& getMaterial() { return _material; }
-        std::vector<float> getVertices() { return _vertices; }
-        std::vector<unsigned int> getIndices() { return _indices; }
+        const GeometryHandle& getGeometry() const { return _geometry; }
+        Span<const float> getVertices() const { return _geometry ? _geometry->vertices() : Span<const float>(); }
+        Span<const unsigned int> getIndices() const { return _geometry ? _geometry->indices() : Span<const unsigned int>(); }
     protected:
         unsigned int _VAO, _VBO, _EBO;
         unsigned int _floatsPerVert;
         std::vector<float> _vertices;
         std::vector<unsigned int> _indices;
+        GeometryHandle _geometry;
         Material _material;
 
         virtual void generateMesh() = 0;
@@ -90,12 +98,14 @@ class Mesh : public Entity {
             glBindVertexArray(_VAO);
 
             glBindBuffer(GL_ARRAY_BUFFER, _VBO);
-            glBufferData(GL_ARRAY_BUFFER, _vertices.size() * sizeof(float), _vertices.data(), GL_STATIC_DRAW);
+            Span<const float> vertices = _geometry->vertices();
+            Span<const unsigned int> indices = _geometry->indices();
+            glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
 
-            if (!_indices.empty()) {
+            if (!indices.empty()) {
                 glGenBuffers(1, &_EBO);
                 glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _EBO);
-                glBufferData(GL_ELEMENT_ARRAY_BUFFER, _indices.size() * sizeof(unsigned int), _indices.data(), GL_STATIC_DRAW);
+                glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
             }
 
             glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void*) 0);
@@ -0,0 +1,94 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include <map>
+#include <vector>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include "../editor/entity/util/Transform.h"
+
+struct Keyframe {
+    int frame;
+    Transform transform;
+};
+
+class TransformTrack {
+    public:
+        void setKey(int frame, const Transform& transform) {
+            auto it = std::lower_bound(_keys.begin(), _keys.end(), frame, [](const Keyframe& key, int f) { return key.frame < f; });
+            if (it != _keys.end() && it->frame == frame)
+                it->transform = transform;
+            else
+                _keys.insert(it, {frame, transform});
+        }
+
+        void removeKey(int frame) {
+            _keys.erase(std::remove_if(_keys.begin(), _keys.end(), [frame](const Keyframe& key) { return key.frame == frame; }), _keys.end());
+        }
+
+        Transform evaluate(float frame) const {
+            if (_keys.empty())
+                return Transform();
+            if (frame <= _keys.front().frame)
+                return _keys.front().transform;
+            if (frame >= _keys.back().frame)
+                return _keys.back().transform;
+
+            auto next = std::upper_bound(_keys.begin(), _keys.end(), frame, [](float f, const Keyframe& key) { return f < key.frame; });
+            const Keyframe& a = *(next - 1);
+            const Keyframe& b = *next;
+            float t = (frame - a.frame) / float(b.frame - a.frame);
+
+            Transform result;
+            result.position = glm::mix(a.transform.position, b.transform.position, t);
+            result.rotation = glm::mix(a.transform.rotation, b.transform.rotation, t);
+            result.scale = glm::mix(a.transform.scale, b.transform.scale, t);
+            return result;
+        }
+
+        bool hasKey(int frame) const {
+            return std::any_of(_keys.begin(), _keys.end(), [frame](const Keyframe& key) { return key.frame == frame; });
+        }
+
+        bool empty() const { return _keys.empty(); }
+        const std::vector<Keyframe>& keys() const { return _keys; }
+    private:
+        std::vector<Keyframe> _keys;
+};
+
+class AnimationSequence {
+    public:
+        void setKey(int entityId, int frame, const Transform& transform) {
+            _tracks[entityId].setKey(frame, transform);
+        }
+
+        void removeKey(int entityId, int frame) {
+            auto it = _tracks.find(entityId);
+            if (it == _tracks.end())
+                return;
+            it->second.removeKey(frame);
+            if (it->second.empty())
+                _tracks.erase(it);
+        }
+
+        void removeTrack(int entityId) { _tracks.erase(entityId); }
+        void clear() { _tracks.clear(); }
+
+        const TransformTrack* track(int entityId) const {
+            auto it = _tracks.find(entityId);
+            return it != _tracks.end() ? &it->second : nullptr;
+        }
+
+        const std::map<int, TransformTrack>& tracks() const { return _tracks; }
+        int& startFrame() { return _startFrame; }
+        int& endFrame() { return _endFrame; }
+        int startFrame() const { return _startFrame; }
+        int endFrame() const { return _endFrame; }
+    private:
+        std::map<int, TransformTrack> _tracks;
+        int _startFrame = 1;
+        int _endFrame = 48;
+};
+
+#endif
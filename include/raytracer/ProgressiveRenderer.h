@@ -0,0 +1,125 @@
+#ifndef PROGRESSIVERENDERER_H
+#define PROGRESSIVERENDERER_H
+
+#include "Raytracer.h"
+#include <thread>
+#include <atomic>
+#include <functional>
+
+class ProgressiveRenderer {
+    public:
+        std::function<void(const RenderTile& tile)> onTileFinished;
+        std::function<void(int width, int height)> onResize;
+
+        ProgressiveRenderer() {
+            _camera.onTileFinished = [this](const RenderTile& tile) {
+                if (onTileFinished) onTileFinished(tile);
+            };
+        }
+
+        ~ProgressiveRenderer() {
+            stop();
+        }
+
+        bool update(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor, const Transform& cameraTransform, int width, float aspectRatio) {
+            int height = std::max(int(width / aspectRatio), 1);
+            size_t sceneHash = Raytracer::sceneHash(entities, skyboxColor);
+
+            bool sceneChanged = !_running || sceneHash != _sceneHash;
+            bool sizeChanged = width != _width || height != _height;
+            bool viewChanged = sizeChanged || _maxDepth != _camera.maxDepth() || _integrator != _camera.integrator() || _sortRays != _camera.sortRays()
+                || _cacheOccluders != _camera.cacheOccluders()
+                || _lightSelection != _camera.lightSelection() || _lightSamples != _camera.lightSamples()
+                || cameraTransform.position != _cameraTransform.position
+                || cameraTransform.rotation != _cameraTransform.rotation;
+
+            if (!sceneChanged && !viewChanged)
+                return false;
+
+            stop();
+
+            if (sceneChanged) {
+                Raytracer::buildScene(entities, skyboxColor, _scene);
+                _sceneHash = sceneHash;
+            }
+
+            if (sizeChanged) {
+                _width = width;
+                _height = height;
+                _display.assign(size_t(width) * height * 3, 0);
+                if (onResize) onResize(width, height);
+            }
+
+            _cameraTransform = cameraTransform;
+            _camera.transform() = cameraTransform;
+            _camera.aspectRatio() = aspectRatio;
+            _camera.imageWidth() = width;
+            _camera.maxDepth() = _maxDepth;
+            _camera.integrator() = _integrator;
+            _camera.sortRays() = _sortRays;
+            _camera.cacheOccluders() = _cacheOccluders;
+            _camera.lightSelection() = _lightSelection;
+            _camera.lightSamples() = _lightSamples;
+            _camera.skyboxColor() = _scene.skyboxColor;
+            _camera.imageDataBuffer = _display.data();
+
+            start();
+            return true;
+        }
+
+        void stop() {
+            _cancel = true;
+            if (_thread.joinable())
+                _thread.join();
+            _running = false;
+        }
+
+        const unsigned char* display() const { return _display.data(); }
+        int width() const { return _width; }
+        int height() const { return _height; }
+        int samples() const { return _samples.load(); }
+        bool running() const { return _running; }
+        int& maxSamples() { return _maxSamples; }
+        int& maxDepth() { return _maxDepth; }
+        Integrator& integrator() { return _integrator; }
+        bool& sortRays() { return _sortRays; }
+        bool& cacheOccluders() { return _cacheOccluders; }
+        LightSelection& lightSelection() { return _lightSelection; }
+        int& lightSamples() { return _lightSamples; }
+        RayCamera& camera() { return _camera; }
+    private:
+        RayCamera _camera;
+        RenderScene _scene;
+        size_t _sceneHash = 0;
+        Transform _cameraTransform;
+
+        int _width = 0;
+        int _height = 0;
+        int _maxSamples = 1024;
+        int _maxDepth = 8;
+        Integrator _integrator = Integrator::Megakernel;
+        bool _sortRays = false;
+        bool _cacheOccluders = true;
+        LightSelection _lightSelection = LightSelection::All;
+        int _lightSamples = 1;
+        std::vector<unsigned char> _display;
+
+        std::thread _thread;
+        std::atomic<bool> _cancel = false;
+        std::atomic<int> _samples = 0;
+        bool _running = false;
+
+        void start() {
+            _cancel = false;
+            _samples = 0;
+            _running = true;
+
+            _thread = std::thread([this]() {
+                _camera.beginProgressive();
+                while (_camera.progressiveSamples() < _maxSamples && _camera.renderPass(_scene.world, _scene.lights, _cancel))
+                    _samples = _camera.progressiveSamples();
+            });
+        }
+};
+
+#endif
@@ -2,6 +2,9 @@
 #define RAYTRACER_H
 
 #include <stb_image_write.h>
+#include <map>
+#include <array>
+#include <functional>
 
 #include "util/RaytracerUtils.h"
 #include "util/RayCamera.h"
@@ -10,75 +13,130 @@
 #include "util/RayMaterial.h"
 #include "light/RayLightList.h"
 #include "hittable/RayMesh.h"
+#include "RenderScene.h"
+#include "SceneDescription.h"
 
 #include "../editor/entity/Entity.h"
 #include "../editor/entity/mesh/RawMesh.h"
 
 class Raytracer {
     public:
-        static void raytrace(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor, int imageWidth, int samplesPerPixel, int maxDepth) {
-            _world.clear();
-            _lights.clear();
+        static void configureCamera(RayCamera& camera, const Transform& transform, Color skyboxColor, int imageWidth, int samplesPerPixel, int maxDepth) {
+            camera.transform() = transform;
+            camera.aspectRatio() = 16.0 / 9.0;
+            camera.imageWidth() = imageWidth;
+            camera.samplesPerPixel() = samplesPerPixel;
+            camera.maxDepth() = maxDepth;
+            camera.skyboxColor() = skyboxColor;
+        }
+
+        static void buildScene(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor, RenderScene& scene) {
+            describeScene(entities, skyboxColor).build(scene);
+        }
+
+        static SceneDescription describeScene(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor) {
+            SceneDescription description;
+            description.skyboxColor = skyboxColor;
 
             for (const auto& [_, e] : entities) {
                 Transform& transform = e->getTransform();
 
                 if (dynamic_cast<Camera*>(e.get())) {
-                    camera.transform() = transform;
+                    description.cameraTransform = transform;
                 }
 
                 if (Light* light = dynamic_cast<Light*>(e.get())) {
-                    Color color = light->getColor();
-                    float intensity = light->getIntensity();
+                    LightDescription lightDescription;
+                    lightDescription.objectId = e->getId();
+                    lightDescription.color = light->getColor();
+                    lightDescription.intensity = light->getIntensity();
+                    lightDescription.transform = transform;
+
                     if (dynamic_cast<DirectionalLight*>(e.get()))
-                        _lights.add(std::make_shared<RayDirectionalLight>(color, intensity, transform));
+                        lightDescription.type = RayLightType::Directional;
                     if (dynamic_cast<PointLight*>(e.get()))
-                        _lights.add(std::make_shared<RayPointLight>(color, intensity, transform));
-                    if (SpotLight* spotLight = dynamic_cast<SpotLight*>(e.get()))
-                        _lights.add(std::make_shared<RaySpotLight>(color, intensity, transform, spotLight->getSize(), spotLight->getBlend()));
+                        lightDescription.type = RayLightType::Point;
+                    if (SpotLight* spotLight = dynamic_cast<SpotLight*>(e.get())) {
+                        lightDescription.type = RayLightType::Spot;
+                        lightDescription.size = spotLight->getSize();
+                        lightDescription.blend = spotLight->getBlend();
+                    }
+
+                    description.lights.push_back(lightDescription);
                 }
 
                 if (Mesh* mesh = dynamic_cast<Mesh*>(e.get())) {
-                    std::shared_ptr<Hittable> rayMesh;
-
-                    Color albedo = mesh->getMaterial().albedo;
-                    float metallic = mesh->getMaterial().metallic;
-                    float roughness = mesh->getMaterial().roughness;
-                    std::shared_ptr<RayMaterial> rayMaterial = std::make_shared<PBR>(albedo, metallic, roughness);
+                    ShapeDescription shape;
+                    shape.type = RayShapeType::END;
+                    shape.objectId = e->getId();
+                    shape.transform = transform;
+                    shape.albedo = mesh->getMaterial().albedo;
+                    shape.metallic = mesh->getMaterial().metallic;
+                    shape.roughness = mesh->getMaterial().roughness;
 
                     if (dynamic_cast<Sphere*>(e.get()))
-                        rayMesh = std::make_shared<RaySphere>(transform, rayMaterial);
+                        shape.type = RayShapeType::Sphere;
                     if (dynamic_cast<Plane*>(e.get()))
-                        rayMesh = std::make_shared<RayPlane>(transform, rayMaterial);
+                        shape.type = RayShapeType::Plane;
                     if (dynamic_cast<Cube*>(e.get()))
-                        rayMesh = std::make_shared<RayCube>(transform, rayMaterial);
+                        shape.type = RayShapeType::Cube;
                     if (dynamic_cast<Cylinder*>(e.get()))
-                        rayMesh = std::make_shared<RayCylinder>(transform, rayMaterial);
+                        shape.type = RayShapeType::Cylinder;
                     if (dynamic_cast<Cone*>(e.get()))
-                        rayMesh = std::make_shared<RayCone>(transform, rayMaterial);
+                        shape.type = RayShapeType::Cone;
                     if (dynamic_cast<Torus*>(e.get()))
-                        rayMesh = std::make_shared<RayTorus>(transform, rayMaterial);
-                    if (RawMesh* rawMesh = dynamic_cast<RawMesh*>(e.get()))
-                        rayMesh = std::make_shared<RayMesh>(rawMesh->getVertices(), rawMesh->getIndices(), transform, rayMaterial);
+                        shape.type = RayShapeType::Torus;
+                    if (RawMesh* rawMesh = dynamic_cast<RawMesh*>(e.get())) {
+                        shape.type = RayShapeType::Mesh;
+                        shape.geometry = rawMesh->getGeometry();
+                    }
 
-                    if (rayMesh)
-                        _world.add(rayMesh);
+                    if (shape.type != RayShapeType::END)
+                        description.shapes.push_back(std::move(shape));
                 }
             }
 
-            camera.aspectRatio() = 16.0 / 9.0;
-            camera.imageWidth() = imageWidth;
-            camera.samplesPerPixel() = samplesPerPixel;
-            camera.maxDepth() = maxDepth;
-            camera.skyboxColor() = skyboxColor;
+            return description;
+        }
+
+        static size_t sceneHash(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor) {
+            size_t hash = 0;
+            hashCombine(hash, skyboxColor);
+
+            for (const auto& [id, e] : entities) {
+                if (dynamic_cast<Camera*>(e.get()))
+                    continue;
+
+                size_t entityHash = std::hash<int>()(id);
+                const Transform& transform = e->getTransform();
+                hashCombine(entityHash, transform.position);
+                hashCombine(entityHash, transform.rotation);
+                hashCombine(entityHash, transform.scale);
+
+                if (Light* light = dynamic_cast<Light*>(e.get())) {
+                    hashCombine(entityHash, light->getColor());
+                    hashCombine(entityHash, glm::vec3(light->getIntensity()));
+                    if (SpotLight* spotLight = dynamic_cast<SpotLight*>(e.get()))
+                        hashCombine(entityHash, glm::vec3(spotLight->getSize(), spotLight->getBlend(), 0.0f));
+                }
+
+                if (Mesh* mesh = dynamic_cast<Mesh*>(e.get())) {
+                    const Material& material = mesh->getMaterial();
+                    hashCombine(entityHash, material.albedo);
+                    hashCombine(entityHash, glm::vec3(material.metallic, material.roughness, 0.0f));
+                }
+
+                hash += entityHash;
+            }
 
-            camera.render(_world, _lights);
+            return hash;
         }
 
-        inline static RayCamera camera;
     private:
-        inline static HittableList _world;
-        inline static RayLightList _lights;
+        static void hashCombine(size_t& hash, const glm::vec3& value) {
+            for (int i = 0; i < 3; i++)
+                hash ^= std::hash<float>()(value[i]) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
 };
 
 #endif
\ No newline at end of file
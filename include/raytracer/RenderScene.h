@@ -0,0 +1,53 @@
+#ifndef RENDERSCENE_H
+#define RENDERSCENE_H
+
+#include <map>
+#include <array>
+#include <memory>
+
+#include "hittable/HittableList.h"
+#include "hittable/RayMesh.h"
+#include "light/RayLightList.h"
+#include "util/RayMaterial.h"
+#include "util/Arena.h"
+
+struct RenderScene {
+    Arena arena;
+    HittableList world;
+    RayLightList lights;
+    Color skyboxColor{0.0f};
+    Transform cameraTransform;
+    std::map<std::array<float, 5>, std::shared_ptr<RayMaterial>> materials;
+    std::map<const Geometry*, std::pair<std::weak_ptr<const Geometry>, std::shared_ptr<const MeshBVH>>> meshes;
+
+    void clear() {
+        world.clear();
+        lights.clear();
+        materials.clear();
+        for (auto it = meshes.begin(); it != meshes.end();) {
+            if (it->second.first.expired())
+                it = meshes.erase(it);
+            else
+                ++it;
+        }
+        skyboxColor = Color(0.0f);
+        cameraTransform = Transform();
+        arena.release();
+    }
+
+    std::shared_ptr<const MeshBVH> mesh(const GeometryHandle& geometry) {
+        auto& [owner, bvh] = meshes[geometry.get()];
+        if (!bvh || owner.lock() != geometry) {
+            owner = geometry;
+            bvh = std::make_shared<const MeshBVH>(geometry->vertices(), geometry->indices());
+        }
+        return bvh;
+    }
+
+    template<typename T, typename... Args>
+    std::shared_ptr<T> make(Args&&... args) {
+        return std::allocate_shared<T>(ArenaAllocator<T>(&arena), std::forward<Args>(args)...);
+    }
+};
+
+#endif
@@ -0,0 +1,175 @@
+#ifndef SCENEDESCRIPTION_H
+#define SCENEDESCRIPTION_H
+
+#include <vector>
+
+#include "RenderScene.h"
+#include "hittable/RayShapes.h"
+#include "hittable/RayMesh.h"
+#include "light/RayLight.h"
+#include "util/ByteStream.h"
+
+enum class RayShapeType : uint32_t {
+    Sphere,
+    Plane,
+    Cube,
+    Cylinder,
+    Cone,
+    Torus,
+    Mesh,
+    END
+};
+
+enum class RayLightType : uint32_t {
+    Directional,
+    Point,
+    Spot,
+    END
+};
+
+struct ShapeDescription {
+    RayShapeType type = RayShapeType::Sphere;
+    int objectId = -1;
+    Transform transform;
+    Color albedo{0.5f};
+    float metallic = 0.0f;
+    float roughness = 0.5f;
+    GeometryHandle geometry;
+};
+
+struct LightDescription {
+    RayLightType type = RayLightType::Point;
+    int objectId = -1;
+    Color color{1.0f};
+    float intensity = 1.0f;
+    Transform transform;
+    float size = 0.0f;
+    float blend = 0.0f;
+};
+
+struct SceneDescription {
+    Color skyboxColor{0.0f};
+    Transform cameraTransform;
+    std::vector<ShapeDescription> shapes;
+    std::vector<LightDescription> lights;
+
+    void build(RenderScene& scene) const {
+        scene.clear();
+        scene.skyboxColor = skyboxColor;
+        scene.cameraTransform = cameraTransform;
+        scene.lights.lights.reserve(lights.size());
+        scene.world.objects.reserve(shapes.size());
+
+        for (const LightDescription& light : lights) {
+            if (light.type == RayLightType::Directional)
+                scene.lights.add(scene.make<RayDirectionalLight>(light.color, light.intensity, light.transform));
+            if (light.type == RayLightType::Point)
+                scene.lights.add(scene.make<RayPointLight>(light.color, light.intensity, light.transform));
+            if (light.type == RayLightType::Spot)
+                scene.lights.add(scene.make<RaySpotLight>(light.color, light.intensity, light.transform, light.size, light.blend));
+        }
+
+        for (const ShapeDescription& shape : shapes) {
+            std::shared_ptr<Hittable> hittable;
+            std::shared_ptr<RayMaterial> material = getMaterial(shape, scene);
+
+            switch (shape.type) {
+                case RayShapeType::Sphere: hittable = scene.make<RaySphere>(shape.transform, material); break;
+                case RayShapeType::Plane: hittable = scene.make<RayPlane>(shape.transform, material); break;
+                case RayShapeType::Cube: hittable = scene.make<RayCube>(shape.transform, material); break;
+                case RayShapeType::Cylinder: hittable = scene.make<RayCylinder>(shape.transform, material); break;
+                case RayShapeType::Cone: hittable = scene.make<RayCone>(shape.transform, material); break;
+                case RayShapeType::Torus: hittable = scene.make<RayTorus>(shape.transform, material); break;
+                case RayShapeType::Mesh: if (shape.geometry) hittable = scene.make<RayMesh>(scene.mesh(shape.geometry), shape.transform, material); break;
+                default: break;
+            }
+
+            if (hittable) {
+                hittable->objectId() = shape.objectId;
+                scene.world.add(hittable);
+            }
+        }
+
+        scene.world.build();
+        scene.lights.build();
+    }
+
+    void serialize(ByteWriter& writer) const {
+        writer.write(skyboxColor);
+        writer.write(cameraTransform);
+
+        writer.write((uint64_t)shapes.size());
+        for (const ShapeDescription& shape : shapes) {
+            writer.write(shape.type);
+            writer.write(shape.objectId);
+            writer.write(shape.transform);
+            writer.write(shape.albedo);
+            writer.write(shape.metallic);
+            writer.write(shape.roughness);
+            Span<const float> vertices = shape.geometry ? shape.geometry->vertices() : Span<const float>();
+            Span<const unsigned int> indices = shape.geometry ? shape.geometry->indices() : Span<const unsigned int>();
+            writer.write((uint64_t)vertices.size());
+            writer.writeBytes(vertices.data(), vertices.size() * sizeof(float));
+            writer.write((uint64_t)indices.size());
+            writer.writeBytes(indices.data(), indices.size() * sizeof(unsigned int));
+        }
+
+        writer.write((uint64_t)lights.size());
+        for (const LightDescription& light : lights)
+            writer.write(light);
+    }
+
+    bool deserialize(ByteReader& reader) {
+        uint64_t shapeCount = 0;
+        if (!reader.read(skyboxColor) || !reader.read(cameraTransform) || !reader.read(shapeCount))
+            return false;
+
+        shapes.clear();
+        for (uint64_t i = 0; i < shapeCount; i++) {
+            ShapeDescription shape;
+            std::vector<float> vertices;
+            std::vector<unsigned int> indices;
+            bool valid = reader.read(shape.type) && reader.read(shape.objectId) && reader.read(shape.transform)
+                && reader.read(shape.albedo) && reader.read(shape.metallic) && reader.read(shape.roughness)
+                && reader.readVector(vertices) && reader.readVector(indices);
+            if (!valid || shape.type >= RayShapeType::END || vertices.size() % Geometry::FloatsPerVertex != 0)
+                return false;
+            for (unsigned int index : indices) {
+                if (index >= vertices.size() / Geometry::FloatsPerVertex)
+                    return false;
+            }
+            if (!vertices.empty() || !indices.empty())
+                shape.geometry = Geometry::create(std::move(vertices), std::move(indices));
+            shapes.push_back(std::move(shape));
+        }
+
+        uint64_t lightCount = 0;
+        if (!reader.read(lightCount))
+            return false;
+
+        lights.clear();
+        for (uint64_t i = 0; i < lightCount; i++) {
+            LightDescription light;
+            if (!reader.read(light) || light.type >= RayLightType::END)
+                return false;
+            lights.push_back(light);
+        }
+
+        return true;
+    }
+
+    static std::shared_ptr<RayMaterial> getMaterial(const ShapeDescription& shape, RenderScene& scene) {
+        std::array<float, 5> key = {shape.albedo.r, shape.albedo.g, shape.albedo.b, shape.metallic, shape.roughness};
+
+        auto it = scene.materials.find(key);
+        if (it != scene.materials.end())
+            return it->second;
+
+        std::shared_ptr<RayMaterial> rayMaterial = scene.make<PBR>(shape.albedo, shape.metallic, shape.roughness);
+        rayMaterial->id() = (int)scene.materials.size();
+        scene.materials.emplace(key, rayMaterial);
+        return rayMaterial;
+    }
+};
+
+#endif
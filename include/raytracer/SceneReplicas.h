@@ -0,0 +1,52 @@
+#ifndef SCENEREPLICAS_H
+#define SCENEREPLICAS_H
+
+#include "SceneDescription.h"
+#include "util/RayCamera.h"
+#include "util/Topology.h"
+#include <thread>
+#include <memory>
+#include <vector>
+
+class SceneReplicas {
+    public:
+        SceneReplicas() { resize(1); }
+
+        void resize(int count) {
+            _scenes.clear();
+            for (int i = 0; i < std::max(count, 1); i++)
+                _scenes.push_back(std::make_unique<RenderScene>());
+        }
+
+        void build(const SceneDescription& description, const Topology& topology = Topology::system()) {
+            if (_scenes.size() == 1) {
+                description.build(*_scenes.front());
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < _scenes.size(); i++) {
+                threads.emplace_back([&, i]() {
+                    Topology::pinCurrentThread(topology.node(int(i) % topology.nodeCount()).cpus);
+                    description.build(*_scenes[i]);
+                });
+            }
+            for (auto& t : threads)
+                t.join();
+        }
+
+        std::vector<SceneView> views() const {
+            std::vector<SceneView> result;
+            for (const auto& scene : _scenes)
+                result.push_back({&scene->world, &scene->lights});
+            return result;
+        }
+
+        int count() const { return (int)_scenes.size(); }
+        RenderScene& primary() { return *_scenes.front(); }
+        const RenderScene& replica(int node) const { return *_scenes[std::min(node, count() - 1)]; }
+    private:
+        std::vector<std::unique_ptr<RenderScene>> _scenes;
+};
+
+#endif
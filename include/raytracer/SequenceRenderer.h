@@ -0,0 +1,141 @@
+#ifndef SEQUENCERENDERER_H
+#define SEQUENCERENDERER_H
+
+#include "Raytracer.h"
+#include "Animation.h"
+#include "output/RenderOutput.h"
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <filesystem>
+#include <unordered_map>
+
+class SequenceRenderer {
+    public:
+        std::function<void(int frame, const std::string& path)> onFrameWritten;
+
+        bool render(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor, const AnimationSequence& sequence, RayCamera& camera, const std::string& outputPattern) {
+            int cameraId = -1;
+            for (const auto& [id, e] : entities) {
+                if (dynamic_cast<Camera*>(e.get()))
+                    cameraId = id;
+            }
+
+            camera.sceneHash() = Raytracer::sceneHash(entities, skyboxColor);
+            return render(Raytracer::describeScene(entities, skyboxColor), cameraId, sequence, camera, outputPattern);
+        }
+
+        bool render(const SceneDescription& description, int cameraId, const AnimationSequence& sequence, RayCamera& camera, const std::string& outputPattern) {
+            _cancel = false;
+            description.build(_scene);
+
+            std::unordered_map<int, Hittable*> shapes;
+            for (const auto& object : _scene.world.objects)
+                shapes[object->objectId()] = object.get();
+
+            std::unordered_map<int, RayLight*> lights;
+            for (size_t i = 0; i < description.lights.size(); i++)
+                lights[description.lights[i].objectId] = _scene.lights.lights[i].get();
+
+            camera.skyboxColor() = description.skyboxColor;
+            camera.transform() = description.cameraTransform;
+            camera.resume() = false;
+
+            std::thread encoder;
+            std::atomic<bool> encoded(true);
+
+            for (int frame = sequence.startFrame(); frame <= sequence.endFrame() && !_cancel; frame++) {
+                _frame = frame;
+
+                for (const auto& [id, track] : sequence.tracks()) {
+                    Transform transform = track.evaluate(float(frame));
+                    if (id == cameraId) {
+                        camera.transform() = transform;
+                    } else if (auto shape = shapes.find(id); shape != shapes.end()) {
+                        shape->second->setTransform(transform);
+                    } else if (auto light = lights.find(id); light != lights.end()) {
+                        light->second->transform() = transform;
+                    }
+                }
+
+                _scene.world.refit();
+                _scene.lights.build();
+                camera.render(_scene.world, _scene.lights);
+
+                if (encoder.joinable())
+                    encoder.join();
+
+                RenderBuffers buffers = camera.buffers();
+                std::vector<unsigned char> display;
+                if (camera.imageDataBuffer)
+                    display.assign(camera.imageDataBuffer, camera.imageDataBuffer + size_t(camera.imageWidth()) * camera.imageHeight() * 3);
+                std::string path = framePath(outputPattern, frame);
+                bool denoised = camera.denoise();
+                Tonemapper tonemapper = camera.tonemapper();
+
+                encoder = std::thread([this, frame, path, denoised, tonemapper, &encoded, buffers = std::move(buffers), display = std::move(display)]() {
+                    if (!writeFrame(path, buffers, display, denoised, tonemapper))
+                        encoded = false;
+                    if (onFrameWritten) onFrameWritten(frame, path);
+                });
+            }
+
+            if (encoder.joinable())
+                encoder.join();
+
+            return encoded && !_cancel;
+        }
+
+        void cancel() { _cancel = true; }
+        int currentFrame() const { return _frame; }
+
+        static std::string framePath(const std::string& pattern, int frame) {
+            size_t end = pattern.find_last_of('#');
+            if (end == std::string::npos) {
+                std::filesystem::path path(pattern);
+                std::string stem = path.stem().string() + "_" + padded(frame, 4);
+                return (path.parent_path() / (stem + path.extension().string())).string();
+            }
+
+            size_t start = end;
+            while (start > 0 && pattern[start - 1] == '#')
+                start--;
+            return pattern.substr(0, start) + padded(frame, int(end - start + 1)) + pattern.substr(end + 1);
+        }
+    private:
+        RenderScene _scene;
+        std::atomic<bool> _cancel = false;
+        std::atomic<int> _frame = 0;
+
+        static std::string padded(int value, int width) {
+            std::string digits = std::to_string(value);
+            return digits.size() < size_t(width) ? std::string(width - digits.size(), '0') + digits : digits;
+        }
+
+        static bool writeFrame(const std::string& path, const RenderBuffers& buffers, const std::vector<unsigned char>& display, bool denoised, const Tonemapper& tonemapper) {
+            std::filesystem::path file(path);
+            std::error_code error;
+            if (file.has_parent_path())
+                std::filesystem::create_directories(file.parent_path(), error);
+
+            std::string extension = file.extension().string();
+            if (extension == ".exr")
+                return RenderOutput::saveLayers(path, buffers, denoised);
+            if (extension == ".hdr")
+                return RenderOutput::saveHDR(path, buffers, denoised);
+            if (extension == ".pfm")
+                return RenderOutput::savePFM(path, buffers, denoised);
+
+            std::vector<unsigned char> pixels;
+            if (display.empty()) {
+                const BufferVector<Color>& image = denoised ? buffers.denoised : buffers.color;
+                pixels.resize(image.size() * 3);
+                tonemapper.apply(image.data(), image.size(), pixels.data());
+            }
+
+            stbi_flip_vertically_on_write(true);
+            return stbi_write_png(path.c_str(), buffers.width(), buffers.height(), 3, display.empty() ? pixels.data() : display.data(), buffers.width() * 3) != 0;
+        }
+};
+
+#endif
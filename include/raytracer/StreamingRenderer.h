@@ -0,0 +1,183 @@
+#ifndef STREAMINGRENDERER_H
+#define STREAMINGRENDERER_H
+
+#include "Raytracer.h"
+#include "output/RenderOutput.h"
+#include "output/TileFile.h"
+#include <atomic>
+#include <functional>
+#include <filesystem>
+
+class StreamingRenderer {
+    public:
+        std::function<void(int band, int bandCount)> onBandFinished;
+
+        bool render(const std::unordered_map<int, std::unique_ptr<Entity>>& entities, Color skyboxColor, RayCamera& camera, const std::string& outputPath) {
+            Raytracer::buildScene(entities, skyboxColor, _scene);
+            camera.transform() = _scene.cameraTransform;
+            camera.skyboxColor() = skyboxColor;
+
+            bool rendered = render(_scene.world, _scene.lights, camera, outputPath);
+            _scene.clear();
+            return rendered;
+        }
+
+        bool render(const Hittable& world, const RayLightList& lights, RayCamera& camera, const std::string& outputPath) {
+            std::string tilePath = outputPath + ".tiles";
+            if (!renderTiles(world, lights, camera, tilePath) || !assemble(tilePath, outputPath))
+                return false;
+
+            std::error_code error;
+            std::filesystem::remove(tilePath, error);
+            return true;
+        }
+
+        bool renderTiles(const Hittable& world, const RayLightList& lights, RayCamera& camera, const std::string& tilePath) {
+            _cancel = false;
+            _band = 0;
+
+            unsigned char* display = camera.imageDataBuffer;
+            RenderTile window = camera.window();
+            float checkpointInterval = camera.checkpointInterval();
+            camera.imageDataBuffer = nullptr;
+            camera.checkpointInterval() = 0.0f;
+            camera.resume() = false;
+
+            int width = camera.imageWidth();
+            int height = camera.frameHeight();
+            int tileSize = camera.tileSize();
+            int bandHeight = std::max(_bandRows, 1) * tileSize;
+            int bandCount = (height + bandHeight - 1) / bandHeight;
+            int apron = camera.denoise() ? camera.denoiser().apron() : 0;
+
+            TileFile file;
+            bool written = true;
+            std::vector<float> pixels;
+
+            for (int band = 0; band < bandCount && written && !_cancel; band++) {
+                int y0 = band * bandHeight;
+                int y1 = std::min(y0 + bandHeight, height);
+
+                camera.window() = {0, std::max(y0 - apron, 0), width, std::min(y1 + apron, height)};
+                camera.render(world, lights);
+
+                const RenderBuffers& buffers = camera.buffers();
+                std::vector<RenderLayer> layers = RenderOutput::layers(buffers, camera.denoise());
+
+                if (band == 0) {
+                    std::vector<std::string> names;
+                    for (const RenderLayer& layer : layers)
+                        names.push_back(layer.name);
+                    written = file.create(tilePath, width, height, tileSize, names);
+                }
+
+                for (const RenderTile& tile : buffers.tiles()) {
+                    if (!written || tile.y0 < y0 || tile.y1 > y1)
+                        continue;
+                    packTile(buffers, layers, tile, pixels);
+                    written = file.writeTile(tile, pixels);
+                }
+
+                _band = band + 1;
+                if (onBandFinished) onBandFinished(band + 1, bandCount);
+            }
+
+            camera.imageDataBuffer = display;
+            camera.window() = window;
+            camera.checkpointInterval() = checkpointInterval;
+
+            return written && !_cancel && file.complete();
+        }
+
+        static bool assemble(const std::string& tilePath, const std::string& outputPath) {
+            TileFile file;
+            if (!file.open(tilePath))
+                return false;
+
+            std::string extension = std::filesystem::path(outputPath).extension().string();
+            int width = file.width();
+            size_t channelCount = file.channels().size();
+            std::vector<float> rows(size_t(width) * file.tileSize() * channelCount);
+            std::vector<float> pixels;
+
+            auto loadTileRow = [&](int ty) {
+                for (int tx = 0; tx < file.tilesX(); tx++) {
+                    RenderTile tile = file.tile(tx, ty);
+                    if (!file.readTile(tile, pixels))
+                        return false;
+
+                    for (int y = 0; y < tile.height(); y++) {
+                        const float* src = &pixels[size_t(y) * tile.width() * channelCount];
+                        std::copy(src, src + size_t(tile.width()) * channelCount, &rows[(size_t(y) * width + tile.x0) * channelCount]);
+                    }
+                }
+                return true;
+            };
+
+            if (extension == ".pfm") {
+                if (channelCount < 3)
+                    return false;
+
+                std::ofstream output(outputPath, std::ios::binary);
+                if (!output)
+                    return false;
+                output << "PF\n" << width << " " << file.height() << "\n-1.0\n";
+
+                std::vector<float> rgb(size_t(width) * 3);
+                for (int ty = 0; ty < file.tilesY(); ty++) {
+                    if (!loadTileRow(ty))
+                        return false;
+
+                    for (int y = 0; y < file.tile(0, ty).height(); y++) {
+                        for (int x = 0; x < width; x++) {
+                            const float* pixel = &rows[(size_t(y) * width + x) * channelCount];
+                            std::copy(pixel, pixel + 3, &rgb[size_t(x) * 3]);
+                        }
+                        output.write(reinterpret_cast<const char*>(rgb.data()), rgb.size() * sizeof(float));
+                    }
+                }
+                return output.good();
+            }
+
+            if (extension != ".exr")
+                return false;
+
+            ExrWriter exr(width, file.height());
+            if (!exr.begin(outputPath, file.channels()))
+                return false;
+
+            for (int ty = file.tilesY() - 1; ty >= 0; ty--) {
+                if (!loadTileRow(ty))
+                    return false;
+
+                for (int y = file.tile(0, ty).height() - 1; y >= 0; y--) {
+                    if (!exr.writeRow(&rows[size_t(y) * width * channelCount]))
+                        return false;
+                }
+            }
+            return exr.end();
+        }
+
+        void cancel() { _cancel = true; }
+        int& bandRows() { return _bandRows; }
+        int currentBand() const { return _band; }
+    private:
+        RenderScene _scene;
+        int _bandRows = 16;
+        std::atomic<bool> _cancel = false;
+        std::atomic<int> _band = 0;
+
+        static void packTile(const RenderBuffers& buffers, const std::vector<RenderLayer>& layers, const RenderTile& tile, std::vector<float>& pixels) {
+            pixels.resize(size_t(tile.width()) * tile.height() * layers.size());
+            float* out = pixels.data();
+            for (int j = tile.y0; j < tile.y1; j++) {
+                for (int i = tile.x0; i < tile.x1; i++) {
+                    int index = buffers.index(i, j);
+                    for (const RenderLayer& layer : layers)
+                        *out++ = layer.value(index);
+                }
+            }
+        }
+};
+
+#endif
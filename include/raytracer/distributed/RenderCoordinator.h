@@ -0,0 +1,278 @@
+#ifndef RENDERCOORDINATOR_H
+#define RENDERCOORDINATOR_H
+
+#include "RenderProtocol.h"
+#include "../SceneDescription.h"
+#include <deque>
+#include <memory>
+#include <algorithm>
+#include <random>
+#include <atomic>
+#include <chrono>
+#include <poll.h>
+#include <sys/wait.h>
+
+class RenderCoordinator {
+    public:
+        ~RenderCoordinator() {
+            shutdown();
+        }
+
+        void listen(const std::string& address) {
+            if (_listener.valid() && address == _address)
+                return;
+            _listener = Socket::listen(address);
+            _address = address;
+        }
+
+        void spawnLocalWorkers(int count, const std::string& executable) {
+            if (!_listener.valid())
+                throw std::runtime_error("Coordinator must listen before spawning workers");
+
+            reapChildren();
+            for (int i = (int)_children.size(); i < count; i++) {
+                pid_t pid = fork();
+                if (pid == 0) {
+                    execl(executable.c_str(), executable.c_str(), "--connect", _address.c_str(), (char*)nullptr);
+                    _exit(127);
+                }
+                if (pid < 0)
+                    throw std::runtime_error("Failed to spawn " + executable);
+                _children.push_back(pid);
+            }
+        }
+
+        bool waitForWorkers(int count, std::chrono::milliseconds timeout) {
+            auto deadline = std::chrono::steady_clock::now() + timeout;
+            while ((int)_workers.size() < count) {
+                auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+                if (remaining.count() <= 0)
+                    return false;
+
+                pollfd listener = {_listener.fd(), POLLIN, 0};
+                if (poll(&listener, 1, (int)remaining.count()) > 0)
+                    acceptWorker();
+            }
+            return true;
+        }
+
+        bool render(RayCamera& camera, const SceneDescription& scene) {
+            _cancel = false;
+            reapChildren();
+            if (_workers.empty() && !waitForWorkers(1, std::chrono::seconds(10)))
+                throw std::runtime_error("No render workers connected to " + _address);
+
+            camera.samplerSeed() = (uint64_t(std::random_device{}()) << 32) | std::random_device{}();
+            camera.samplerPass() = 0;
+            camera.prepare();
+            camera.beginRender();
+
+            _scenePayload.clear();
+            scene.serialize(_scenePayload);
+            _frameSettings = FrameSettings::from(camera);
+            _frameSettings.frame = ++_frame;
+
+            for (auto& worker : _workers)
+                startFrame(*worker);
+
+            const std::vector<RenderTile>& tiles = camera.jobs();
+            std::deque<uint32_t> pending;
+            for (uint32_t t = 0; t < tiles.size(); t++)
+                pending.push_back(t);
+
+            size_t remaining = tiles.size();
+            size_t resultLimit = 0;
+            for (const RenderTile& tile : tiles)
+                resultLimit = std::max(resultLimit, camera.buffers().tileBytes(tile));
+            resultLimit += sizeof(uint32_t) * 2 + sizeof(RenderCounters);
+            std::vector<pollfd> fds;
+            std::vector<char> payload;
+
+            while (remaining > 0) {
+                if (_cancel) {
+                    camera.cancelRender();
+                    return false;
+                }
+
+                auto now = std::chrono::steady_clock::now();
+                for (auto& worker : _workers) {
+                    for (const InFlightTile& job : worker->inFlight) {
+                        if (job.deadline < now)
+                            worker->alive = false;
+                    }
+                }
+
+                dropDeadWorkers(pending);
+                if (_workers.empty())
+                    throw std::runtime_error("All render workers disconnected");
+
+                for (auto& worker : _workers) {
+                    while (worker->alive && !pending.empty() && worker->inFlight.size() < size_t(worker->threads) * 2) {
+                        uint32_t t = pending.front();
+                        ByteWriter job;
+                        job.write(t);
+                        if (!worker->socket.send(MessageType::Tile, job.data())) {
+                            worker->alive = false;
+                            break;
+                        }
+                        pending.pop_front();
+                        worker->inFlight.push_back({t, now + _tileTimeout});
+                    }
+                }
+
+                fds.clear();
+                fds.push_back({_listener.fd(), POLLIN, 0});
+                for (auto& worker : _workers)
+                    fds.push_back({worker->socket.fd(), POLLIN, 0});
+
+                if (poll(fds.data(), fds.size(), 250) <= 0)
+                    continue;
+
+                for (size_t i = 1; i < fds.size(); i++) {
+                    if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+                        continue;
+
+                    Worker& worker = *_workers[i - 1];
+                    MessageType type;
+                    if (!worker.socket.receive(type, payload, resultLimit) || type != MessageType::TileResult) {
+                        worker.alive = false;
+                        continue;
+                    }
+
+                    ByteReader reader(payload);
+                    uint32_t frame, t;
+                    RenderCounters counters;
+                    if (!reader.read(frame) || !reader.read(t) || !reader.read(counters)) {
+                        worker.alive = false;
+                        continue;
+                    }
+
+                    auto job = std::find_if(worker.inFlight.begin(), worker.inFlight.end(), [t](const InFlightTile& inFlight) {
+                        return inFlight.tile == t;
+                    });
+                    if (frame != _frame || job == worker.inFlight.end())
+                        continue;
+
+                    if (!camera.buffers().readTile(tiles[t], reader)) {
+                        worker.alive = false;
+                        continue;
+                    }
+
+                    worker.inFlight.erase(job);
+                    camera.addStats(counters);
+                    camera.finishTile(tiles[t]);
+                    remaining--;
+                }
+
+                if (fds[0].revents & POLLIN)
+                    startFrame(acceptWorker());
+            }
+
+            camera.endRender(std::thread::hardware_concurrency());
+            return true;
+        }
+
+        void cancel() { _cancel = true; }
+
+        void shutdown() {
+            for (auto& worker : _workers)
+                worker->socket.send(MessageType::Shutdown, {});
+            _workers.clear();
+
+            for (pid_t pid : _children)
+                waitpid(pid, nullptr, 0);
+            _children.clear();
+            _listener.close();
+        }
+
+        int workerCount() const { return (int)_workers.size(); }
+        const std::string& address() const { return _address; }
+        std::chrono::milliseconds& tileTimeout() { return _tileTimeout; }
+    private:
+        struct InFlightTile {
+            uint32_t tile;
+            std::chrono::steady_clock::time_point deadline;
+        };
+
+        struct Worker {
+            Socket socket;
+            int threads = 1;
+            bool alive = true;
+            uint64_t sceneHash = 0;
+            std::vector<InFlightTile> inFlight;
+        };
+
+        Socket _listener;
+        std::string _address;
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::vector<pid_t> _children;
+
+        ByteWriter _scenePayload;
+        FrameSettings _frameSettings;
+        uint32_t _frame = 0;
+        std::chrono::milliseconds _tileTimeout = std::chrono::minutes(2);
+        std::chrono::milliseconds _socketTimeout = std::chrono::seconds(10);
+        std::chrono::milliseconds _helloTimeout = std::chrono::seconds(2);
+        std::atomic<bool> _cancel = false;
+
+        Worker& acceptWorker() {
+            auto worker = std::make_unique<Worker>();
+            worker->socket = _listener.accept();
+
+            pollfd greeting = {worker->socket.fd(), POLLIN, 0};
+            MessageType type;
+            std::vector<char> payload;
+            WorkerHello hello;
+            worker->alive = worker->socket.valid() && worker->socket.setTimeout(_socketTimeout)
+                && poll(&greeting, 1, (int)_helloTimeout.count()) > 0
+                && worker->socket.receive(type, payload, sizeof(WorkerHello)) && type == MessageType::Hello
+                && ByteReader(payload).read(hello) && hello.version == renderProtocolVersion;
+            worker->threads = std::max(1, (int)hello.threads);
+
+            _workers.push_back(std::move(worker));
+            return *_workers.back();
+        }
+
+        void startFrame(Worker& worker) {
+            if (!worker.alive || _frame == 0)
+                return;
+
+            worker.inFlight.clear();
+
+            if (worker.sceneHash == 0 || worker.sceneHash != _frameSettings.sceneHash) {
+                if (!worker.socket.send(MessageType::Scene, _scenePayload.data())) {
+                    worker.alive = false;
+                    return;
+                }
+                worker.sceneHash = _frameSettings.sceneHash;
+            }
+
+            ByteWriter frame;
+            frame.write(_frameSettings);
+            if (!worker.socket.send(MessageType::Frame, frame.data()))
+                worker.alive = false;
+        }
+
+        void dropDeadWorkers(std::deque<uint32_t>& pending) {
+            for (auto it = _workers.begin(); it != _workers.end();) {
+                if ((*it)->alive) {
+                    ++it;
+                    continue;
+                }
+                for (const InFlightTile& job : (*it)->inFlight)
+                    pending.push_front(job.tile);
+                it = _workers.erase(it);
+            }
+        }
+
+        void reapChildren() {
+            for (auto it = _children.begin(); it != _children.end();) {
+                if (waitpid(*it, nullptr, WNOHANG) != 0)
+                    it = _children.erase(it);
+                else
+                    ++it;
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef RENDERPROTOCOL_H
+#define RENDERPROTOCOL_H
+
+#include "Socket.h"
+#include "../util/RayCamera.h"
+#include "../util/ByteStream.h"
+
+static const uint32_t renderProtocolVersion = 7;
+
+struct WorkerHello {
+    uint32_t version = renderProtocolVersion;
+    uint32_t threads = 1;
+};
+
+struct FrameSettings {
+    uint32_t frame = 0;
+    uint64_t sceneHash = 0;
+    uint64_t samplerSeed = 0;
+    uint32_t samplerPass = 0;
+    int imageWidth = 0;
+    float aspectRatio = 1.0f;
+    int samplesPerPixel = 1;
+    int maxDepth = 1;
+    Integrator integrator = Integrator::Megakernel;
+    bool sortRays = false;
+    bool cacheOccluders = true;
+    LightSelection lightSelection = LightSelection::All;
+    int lightSamples = 1;
+    Transform transform;
+    Color skyboxColor{0.0f};
+    AOVSettings aovs;
+    RenderTile window = {0, 0, 0, 0};
+    RenderTile region = {0, 0, 0, 0};
+
+    static FrameSettings from(RayCamera& camera) {
+        FrameSettings settings;
+        settings.sceneHash = camera.sceneHash();
+        settings.samplerSeed = camera.samplerSeed();
+        settings.samplerPass = camera.samplerPass();
+        settings.imageWidth = camera.imageWidth();
+        settings.aspectRatio = camera.aspectRatio();
+        settings.samplesPerPixel = camera.samplesPerPixel();
+        settings.maxDepth = camera.maxDepth();
+        settings.integrator = camera.integrator();
+        settings.sortRays = camera.sortRays();
+        settings.cacheOccluders = camera.cacheOccluders();
+        settings.lightSelection = camera.lightSelection();
+        settings.lightSamples = camera.lightSamples();
+        settings.transform = camera.transform();
+        settings.skyboxColor = camera.skyboxColor();
+        settings.aovs = camera.aovs();
+        settings.window = camera.window();
+        settings.region = camera.region();
+        return settings;
+    }
+
+    void apply(RayCamera& camera) const {
+        camera.sceneHash() = sceneHash;
+        camera.samplerSeed() = samplerSeed;
+        camera.samplerPass() = samplerPass;
+        camera.imageWidth() = imageWidth;
+        camera.aspectRatio() = aspectRatio;
+        camera.samplesPerPixel() = samplesPerPixel;
+        camera.maxDepth() = maxDepth;
+        camera.integrator() = integrator;
+        camera.sortRays() = sortRays;
+        camera.cacheOccluders() = cacheOccluders;
+        camera.lightSelection() = lightSelection;
+        camera.lightSamples() = lightSamples;
+        camera.transform() = transform;
+        camera.skyboxColor() = skyboxColor;
+        camera.aovs() = aovs;
+        camera.window() = window;
+        camera.region() = region;
+        camera.denoise() = false;
+    }
+};
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef RENDERWORKER_H
+#define RENDERWORKER_H
+
+#include "RenderProtocol.h"
+#include "../SceneDescription.h"
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+class RenderWorker {
+    public:
+        explicit RenderWorker(int threads = 0)
+            : _threads(threads > 0 ? threads : std::max(1, (int)std::thread::hardware_concurrency())) {}
+
+        void run(const std::string& address) {
+            _socket = Socket::connect(address);
+
+            ByteWriter hello;
+            hello.write(WorkerHello{renderProtocolVersion, (uint32_t)_threads});
+            if (!_socket.send(MessageType::Hello, hello.data()))
+                throw std::runtime_error("Failed to greet coordinator at " + address);
+
+            std::vector<std::thread> threads;
+            for (int i = 0; i < _threads; i++)
+                threads.emplace_back([this]() { workLoop(); });
+
+            MessageType type;
+            std::vector<char> payload;
+            while (_socket.receive(type, payload)) {
+                ByteReader reader(payload);
+                if (type == MessageType::Shutdown)
+                    break;
+                if (!handleMessage(type, reader))
+                    break;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+                _jobs.clear();
+            }
+            _condition.notify_all();
+            for (auto& thread : threads)
+                thread.join();
+            _socket.close();
+        }
+    private:
+        int _threads;
+        Socket _socket;
+        std::mutex _sendMutex;
+
+        RenderScene _scene;
+        RayCamera _camera;
+        uint32_t _frame = 0;
+
+        std::mutex _mutex;
+        std::condition_variable _condition;
+        std::deque<uint32_t> _jobs;
+        int _busy = 0;
+        bool _stopping = false;
+
+        bool handleMessage(MessageType type, ByteReader& reader) {
+            if (type == MessageType::Scene) {
+                waitIdle();
+                SceneDescription description;
+                if (!description.deserialize(reader))
+                    return false;
+                description.build(_scene);
+                return true;
+            }
+
+            if (type == MessageType::Frame) {
+                waitIdle();
+                FrameSettings settings;
+                if (!reader.read(settings))
+                    return false;
+                settings.apply(_camera);
+                _camera.prepare();
+                _frame = settings.frame;
+                return true;
+            }
+
+            if (type == MessageType::Tile) {
+                uint32_t index;
+                if (!reader.read(index) || index >= _camera.jobs().size())
+                    return false;
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _jobs.push_back(index);
+                }
+                _condition.notify_one();
+                return true;
+            }
+
+            return false;
+        }
+
+        void waitIdle() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _condition.wait(lock, [this]() { return _jobs.empty() && _busy == 0; });
+        }
+
+        void workLoop() {
+            ByteWriter writer;
+            while (true) {
+                uint32_t index;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _condition.wait(lock, [this]() { return _stopping || !_jobs.empty(); });
+                    if (_stopping)
+                        return;
+                    index = _jobs.front();
+                    _jobs.pop_front();
+                    _busy++;
+                }
+
+                RenderStats::takeLocal();
+                _camera.renderJob(index, _scene.world, _scene.lights);
+
+                writer.clear();
+                writer.write(_frame);
+                writer.write(index);
+                writer.write(RenderStats::takeLocal());
+                _camera.buffers().writeTile(_camera.jobs()[index], writer);
+
+                {
+                    std::lock_guard<std::mutex> lock(_sendMutex);
+                    _socket.send(MessageType::TileResult, writer.data());
+                }
+
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _busy--;
+                }
+                _condition.notify_all();
+            }
+        }
+};
+
+#endif
@@ -0,0 +1,217 @@
+#ifndef SOCKET_H
+#define SOCKET_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <chrono>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+enum class MessageType : uint32_t {
+    Hello,
+    Scene,
+    Frame,
+    Tile,
+    TileResult,
+    Shutdown,
+    END
+};
+
+class Socket {
+    public:
+        static constexpr size_t maxPayload = size_t(1) << 30;
+
+        Socket() = default;
+        explicit Socket(int fd) : _fd(fd) {}
+        ~Socket() { close(); }
+
+        Socket(const Socket&) = delete;
+        Socket& operator=(const Socket&) = delete;
+        Socket(Socket&& other) noexcept : _fd(other._fd) { other._fd = -1; }
+        Socket& operator=(Socket&& other) noexcept {
+            if (this != &other) {
+                close();
+                _fd = other._fd;
+                other._fd = -1;
+            }
+            return *this;
+        }
+
+        static Socket connect(const std::string& address) {
+            if (isUnixAddress(address)) {
+                sockaddr_un addr = unixAddress(address);
+                Socket socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+                if (!socket.valid() || ::connect(socket._fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+                    throw std::runtime_error("Failed to connect to " + address);
+                socket.configure();
+                return socket;
+            }
+
+            addrinfo* results = resolve(address, false);
+            for (addrinfo* info = results; info; info = info->ai_next) {
+                Socket socket(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+                if (socket.valid() && ::connect(socket._fd, info->ai_addr, info->ai_addrlen) == 0) {
+                    freeaddrinfo(results);
+                    socket.configure();
+                    return socket;
+                }
+            }
+            freeaddrinfo(results);
+            throw std::runtime_error("Failed to connect to " + address);
+        }
+
+        static Socket listen(const std::string& address) {
+            Socket socket;
+            if (isUnixAddress(address)) {
+                sockaddr_un addr = unixAddress(address);
+                ::unlink(addr.sun_path);
+                socket = Socket(::socket(AF_UNIX, SOCK_STREAM, 0));
+                if (!socket.valid() || ::bind(socket._fd, (sockaddr*)&addr, sizeof(addr)) != 0)
+                    throw std::runtime_error("Failed to bind " + address);
+            } else {
+                addrinfo* results = resolve(address, true);
+                for (addrinfo* info = results; info && !socket.valid(); info = info->ai_next) {
+                    socket = Socket(::socket(info->ai_family, info->ai_socktype, info->ai_protocol));
+                    int reuse = 1;
+                    setsockopt(socket._fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+                    if (socket.valid() && ::bind(socket._fd, info->ai_addr, info->ai_addrlen) != 0)
+                        socket.close();
+                }
+                freeaddrinfo(results);
+                if (!socket.valid())
+                    throw std::runtime_error("Failed to bind " + address);
+            }
+
+            if (::listen(socket._fd, 64) != 0)
+                throw std::runtime_error("Failed to listen on " + address);
+            fcntl(socket._fd, F_SETFD, FD_CLOEXEC);
+            return socket;
+        }
+
+        Socket accept() const {
+            Socket socket(::accept(_fd, nullptr, nullptr));
+            socket.configure();
+            return socket;
+        }
+
+        bool send(MessageType type, const std::vector<char>& payload) {
+            uint32_t header[3] = {(uint32_t)type, uint32_t(payload.size()), uint32_t(uint64_t(payload.size()) >> 32)};
+            return sendAll(header, sizeof(header)) && sendAll(payload.data(), payload.size());
+        }
+
+        bool receive(MessageType& type, std::vector<char>& payload, size_t limit = maxPayload) {
+            uint32_t header[3];
+            if (!receiveAll(header, sizeof(header)) || header[0] >= (uint32_t)MessageType::END)
+                return false;
+
+            uint64_t size = uint64_t(header[1]) | (uint64_t(header[2]) << 32);
+            if (size > limit)
+                return false;
+
+            type = (MessageType)header[0];
+            payload.resize(size_t(size));
+            return receiveAll(payload.data(), payload.size());
+        }
+
+        bool setTimeout(std::chrono::milliseconds timeout) {
+            timeval value = {};
+            value.tv_sec = time_t(timeout.count() / 1000);
+            value.tv_usec = suseconds_t(timeout.count() % 1000 * 1000);
+            return setsockopt(_fd, SOL_SOCKET, SO_RCVTIMEO, &value, sizeof(value)) == 0
+                && setsockopt(_fd, SOL_SOCKET, SO_SNDTIMEO, &value, sizeof(value)) == 0;
+        }
+
+        void close() {
+            if (_fd >= 0)
+                ::close(_fd);
+            _fd = -1;
+        }
+
+        int fd() const { return _fd; }
+        bool valid() const { return _fd >= 0; }
+    private:
+        int _fd = -1;
+
+        static bool isUnixAddress(const std::string& address) {
+            return address.rfind("unix:", 0) == 0;
+        }
+
+        static sockaddr_un unixAddress(const std::string& address) {
+            std::string path = address.substr(5);
+            sockaddr_un addr = {};
+            if (path.size() >= sizeof(addr.sun_path))
+                throw std::runtime_error("Socket path too long: " + path);
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+            return addr;
+        }
+
+        static addrinfo* resolve(const std::string& address, bool passive) {
+            std::string hostPort = address.rfind("tcp:", 0) == 0 ? address.substr(4) : address;
+            size_t separator = hostPort.rfind(':');
+            if (separator == std::string::npos)
+                throw std::runtime_error("Expected host:port in " + address);
+
+            std::string host = hostPort.substr(0, separator);
+            std::string port = hostPort.substr(separator + 1);
+
+            addrinfo hints = {};
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = passive ? AI_PASSIVE : 0;
+
+            addrinfo* results = nullptr;
+            if (getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &results) != 0)
+                throw std::runtime_error("Failed to resolve " + address);
+            return results;
+        }
+
+        void configure() {
+            int enable = 1;
+            fcntl(_fd, F_SETFD, FD_CLOEXEC);
+            setsockopt(_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+#ifdef SO_NOSIGPIPE
+            setsockopt(_fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+        }
+
+        bool sendAll(const void* data, size_t size) {
+            const char* bytes = static_cast<const char*>(data);
+            while (size > 0) {
+                ssize_t sent = ::send(_fd, bytes, size, MSG_NOSIGNAL);
+                if (sent <= 0)
+                    return false;
+                bytes += sent;
+                size -= size_t(sent);
+            }
+            return true;
+        }
+
+        bool receiveAll(void* data, size_t size) {
+            char* bytes = static_cast<char*>(data);
+            while (size > 0) {
+                ssize_t received = ::recv(_fd, bytes, size, 0);
+                if (received <= 0)
+                    return false;
+                bytes += received;
+                size -= size_t(received);
+            }
+            return true;
+        }
+};
+
+#endif
@@ -2,6 +2,7 @@
 #define HITTABLE_H
 
 #include "../util/RaytracerUtils.h"
+#include "../util/RenderStats.h"
 
 class RayMaterial;
 
@@ -12,6 +13,7 @@ class HitRecord {
         float t;
 
         bool frontFace;
+        int objectId = -1;
 
         std::shared_ptr<RayMaterial> material;
 
@@ -40,6 +42,7 @@ class Hittable {
 
             float t = 0.0f;
             for (int i = 0; i < maxSteps; i++) {
+                RenderStats::count(Counter::SDFSteps);
                 glm::vec3 p = o + d * t;
                 float distance = sdf(p);
 
@@ -50,6 +53,7 @@ class Hittable {
                     rec.normal = glm::normalize(glm::vec3(_modelMatrixIT * glm::vec4(n, 0.0f)));
                     rec.setFaceNormal(ray, rec.normal);
                     rec.material = _material;
+                    rec.objectId = _objectId;
                     return true;
                 }
 
@@ -62,6 +66,10 @@ class Hittable {
             return false;
         }
 
+        virtual const Hittable* occluder(const Ray& ray, float lightDist) const {
+            return shadowMarch(ray, lightDist) ? this : nullptr;
+        }
+
         virtual bool shadowMarch(const Ray& ray, float lightDist) const {
             float maxScale = glm::max(glm::max(_transform.scale.x, _transform.scale.y), _transform.scale.z);
             const float epsilon = 1e-3f / maxScale;
@@ -88,6 +96,7 @@ class Hittable {
             if (t >= localLightDist) return false;
 
             for (int i = 0; i < maxSteps; i++) {
+                RenderStats::count(Counter::SDFSteps);
                 float distance = sdf(o + d * t);
                 if (distance < epsilon) return true;
                 if (t > localLightDist) return false;
@@ -100,9 +109,26 @@ class Hittable {
             _transform = transform;
             calculateMatrices();
         }
+
+        void worldBounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+            glm::vec3 localMin = localBoundsMin();
+            glm::vec3 localMax = localBoundsMax();
+            boundsMin = glm::vec3(infinity);
+            boundsMax = glm::vec3(-infinity);
+
+            for (int corner = 0; corner < 8; corner++) {
+                glm::vec3 p((corner & 1) ? localMax.x : localMin.x, (corner & 2) ? localMax.y : localMin.y, (corner & 4) ? localMax.z : localMin.z);
+                glm::vec3 world = glm::vec3(_modelMatrix * glm::vec4(p, 1.0f));
+                boundsMin = glm::min(boundsMin, world);
+                boundsMax = glm::max(boundsMax, world);
+            }
+        }
+
+        int& objectId() { return _objectId; }
     protected:
         Transform _transform;
         std::shared_ptr<RayMaterial> _material;
+        int _objectId = -1;
 
         glm::mat4 _modelMatrix{1.0f};
         glm::mat4 _modelMatrixI{1.0f};
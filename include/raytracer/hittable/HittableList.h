@@ -4,6 +4,9 @@
 #include "Hittable.h"
 #include "../util/RaytracerUtils.h"
 #include <vector>
+#include <numeric>
+#include <algorithm>
+#include <glm/gtx/component_wise.hpp>
 
 class HittableList : public Hittable {
     public:
@@ -12,10 +15,50 @@ class HittableList : public Hittable {
         HittableList() {}
         HittableList(std::shared_ptr<Hittable> object) { add(object); }
 
-        void clear() { objects.clear(); }
+        void clear() {
+            objects.clear();
+            _nodes.clear();
+            _order.clear();
+        }
 
         void add(std::shared_ptr<Hittable> object) {
             objects.push_back(object);
+            _nodes.clear();
+        }
+
+        void build() {
+            _nodes.clear();
+            _order.resize(objects.size());
+            std::iota(_order.begin(), _order.end(), 0);
+            computeBounds();
+
+            if (objects.empty())
+                return;
+            _nodes.emplace_back();
+            buildNode(0, 0, (int)objects.size());
+        }
+
+        void refit() {
+            if (_nodes.empty() || _order.size() != objects.size()) {
+                build();
+                return;
+            }
+
+            computeBounds();
+            for (int i = (int)_nodes.size() - 1; i >= 0; i--) {
+                SceneNode& node = _nodes[i];
+                if (node.count > 0) {
+                    node.boundsMin = glm::vec3(infinity);
+                    node.boundsMax = glm::vec3(-infinity);
+                    for (int k = node.start; k < node.start + node.count; k++) {
+                        node.boundsMin = glm::min(node.boundsMin, _objectMin[_order[k]]);
+                        node.boundsMax = glm::max(node.boundsMax, _objectMax[_order[k]]);
+                    }
+                } else {
+                    node.boundsMin = glm::min(_nodes[node.left].boundsMin, _nodes[node.right].boundsMin);
+                    node.boundsMax = glm::max(_nodes[node.left].boundsMax, _nodes[node.right].boundsMax);
+                }
+            }
         }
 
         bool raymarch(const Ray& ray, HitRecord& rec) const override {
@@ -23,14 +66,40 @@ class HittableList : public Hittable {
             bool hitAnything = false;
             auto closestSoFar = infinity;
 
-            for (const auto& object : objects) {
-                if (object->raymarch(ray, tempRec)) {
-                    float distance = glm::length(tempRec.point - ray.origin());
-                    if (distance < closestSoFar) {
-                        hitAnything = true;
-                        closestSoFar = distance;
-                        rec = tempRec;
-                    }
+            if (_nodes.empty()) {
+                for (const auto& object : objects)
+                    hitObject(*object, ray, tempRec, rec, closestSoFar, hitAnything);
+                return hitAnything;
+            }
+
+            glm::vec3 invD = 1.0f / ray.direction();
+            float invLength = 1.0f / glm::length(ray.direction());
+            int stack[64];
+            int stackSize = 0;
+            stack[stackSize++] = 0;
+
+            while (stackSize > 0) {
+                const SceneNode& node = _nodes[stack[--stackSize]];
+                RenderStats::count(Counter::BVHNodes);
+
+                float tEntry;
+                if (!intersectNode(node, ray.origin(), invD, tEntry) || tEntry > closestSoFar * invLength)
+                    continue;
+
+                if (node.count > 0) {
+                    for (int k = node.start; k < node.start + node.count; k++)
+                        hitObject(*objects[_order[k]], ray, tempRec, rec, closestSoFar, hitAnything);
+                    continue;
+                }
+
+                float tLeft, tRight;
+                bool hitLeft = intersectNode(_nodes[node.left], ray.origin(), invD, tLeft);
+                bool hitRight = intersectNode(_nodes[node.right], ray.origin(), invD, tRight);
+                if (hitLeft && hitRight && stackSize < 63) {
+                    stack[stackSize++] = tLeft <= tRight ? node.right : node.left;
+                    stack[stackSize++] = tLeft <= tRight ? node.left : node.right;
+                } else if (hitLeft || hitRight) {
+                    stack[stackSize++] = hitLeft ? node.left : node.right;
                 }
             }
 
@@ -38,16 +107,132 @@ class HittableList : public Hittable {
         }
 
         bool shadowMarch(const Ray& ray, float lightDist) const override {
-            for (const auto& object : objects) {
-                if (object->shadowMarch(ray, lightDist))
-                    return true;
+            return occluder(ray, lightDist) != nullptr;
+        }
+
+        const Hittable* occluder(const Ray& ray, float lightDist) const override {
+            if (_nodes.empty()) {
+                for (const auto& object : objects) {
+                    if (const Hittable* hit = object->occluder(ray, lightDist))
+                        return hit;
+                }
+                return nullptr;
             }
-            return false;
+
+            glm::vec3 invD = 1.0f / ray.direction();
+            float tLimit = lightDist / glm::length(ray.direction());
+            int stack[64];
+            int stackSize = 0;
+            stack[stackSize++] = 0;
+
+            while (stackSize > 0) {
+                const SceneNode& node = _nodes[stack[--stackSize]];
+                RenderStats::count(Counter::BVHNodes);
+
+                float tEntry;
+                if (!intersectNode(node, ray.origin(), invD, tEntry) || tEntry > tLimit)
+                    continue;
+
+                if (node.count > 0) {
+                    for (int k = node.start; k < node.start + node.count; k++) {
+                        if (const Hittable* hit = objects[_order[k]]->occluder(ray, lightDist))
+                            return hit;
+                    }
+                    continue;
+                }
+
+                if (stackSize < 63) {
+                    stack[stackSize++] = node.right;
+                    stack[stackSize++] = node.left;
+                }
+            }
+            return nullptr;
         }
 
         float sdf(const glm::vec3& p) const override {
             return infinity;
         }
+    private:
+        struct SceneNode {
+            glm::vec3 boundsMin, boundsMax;
+            int left = -1, right = -1;
+            int start = 0, count = 0;
+        };
+
+        static constexpr int LEAF_SIZE = 2;
+
+        std::vector<SceneNode> _nodes;
+        std::vector<int> _order;
+        std::vector<glm::vec3> _objectMin;
+        std::vector<glm::vec3> _objectMax;
+
+        static void hitObject(const Hittable& object, const Ray& ray, HitRecord& tempRec, HitRecord& rec, float& closestSoFar, bool& hitAnything) {
+            if (object.raymarch(ray, tempRec)) {
+                float distance = glm::length(tempRec.point - ray.origin());
+                if (distance < closestSoFar) {
+                    hitAnything = true;
+                    closestSoFar = distance;
+                    rec = tempRec;
+                }
+            }
+        }
+
+        static bool intersectNode(const SceneNode& node, const glm::vec3& o, const glm::vec3& invD, float& tEntry) {
+            glm::vec3 t0 = (node.boundsMin - o) * invD;
+            glm::vec3 t1 = (node.boundsMax - o) * invD;
+            float tmin = glm::compMax(glm::min(t0, t1));
+            float tmax = glm::compMin(glm::max(t0, t1));
+            tEntry = glm::max(tmin, 0.0f);
+            return tmax >= tEntry;
+        }
+
+        void computeBounds() {
+            _objectMin.resize(objects.size());
+            _objectMax.resize(objects.size());
+            for (size_t i = 0; i < objects.size(); i++) {
+                objects[i]->worldBounds(_objectMin[i], _objectMax[i]);
+                glm::vec3 padding = (_objectMax[i] - _objectMin[i]) * 1e-3f + glm::vec3(1e-3f);
+                _objectMin[i] -= padding;
+                _objectMax[i] += padding;
+            }
+        }
+
+        void buildNode(int nodeIdx, int start, int end) {
+            glm::vec3 bMin(infinity), bMax(-infinity);
+            glm::vec3 cMin(infinity), cMax(-infinity);
+            for (int i = start; i < end; i++) {
+                bMin = glm::min(bMin, _objectMin[_order[i]]);
+                bMax = glm::max(bMax, _objectMax[_order[i]]);
+                glm::vec3 centroid = (_objectMin[_order[i]] + _objectMax[_order[i]]) * 0.5f;
+                cMin = glm::min(cMin, centroid);
+                cMax = glm::max(cMax, centroid);
+            }
+            _nodes[nodeIdx].boundsMin = bMin;
+            _nodes[nodeIdx].boundsMax = bMax;
+
+            int count = end - start;
+            if (count <= LEAF_SIZE) {
+                _nodes[nodeIdx].start = start;
+                _nodes[nodeIdx].count = count;
+                return;
+            }
+
+            glm::vec3 extent = cMax - cMin;
+            int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+
+            int mid = (start + end) / 2;
+            std::nth_element(_order.begin() + start, _order.begin() + mid, _order.begin() + end, [&](int a, int b) {
+                return _objectMin[a][axis] + _objectMax[a][axis] < _objectMin[b][axis] + _objectMax[b][axis];
+            });
+
+            int leftIdx = (int)_nodes.size(); _nodes.emplace_back();
+            int rightIdx = (int)_nodes.size(); _nodes.emplace_back();
+            _nodes[nodeIdx].left = leftIdx;
+            _nodes[nodeIdx].right = rightIdx;
+
+            buildNode(leftIdx, start, mid);
+            buildNode(rightIdx, mid, end);
+        }
 };
 
 #endif
\ No newline at end of file
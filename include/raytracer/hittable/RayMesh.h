@@ -3,6 +3,7 @@
 
 #include "Hittable.h"
 #include "../../editor/entity/util/Transform.h"
+#include "../../editor/entity/mesh/Geometry.h"
 #include <numeric>
 #include <glm/gtx/component_wise.hpp>
 #include <algorithm>
@@ -18,11 +19,10 @@ struct BVHNode {
     int triStart = -1, triCount = 0;
 };
 
-class RayMesh : public Hittable {
+class MeshBVH {
     public:
-        RayMesh(const std::vector<float>& verts, const std::vector<unsigned int>& indices, const Transform& transform, std::shared_ptr<RayMaterial> material) {
-            _material = material;
-
+        MeshBVH(Span<const float> verts, Span<const unsigned int> indices) {
+            _triangles.reserve(indices.size() / 3);
             for (size_t i = 0; i < indices.size(); i += 3) {
                 auto v = [&](int idx) { return glm::vec3(verts[idx*6], verts[idx*6+1], verts[idx*6+2]); };
                 auto n = [&](int idx) { return glm::vec3(verts[idx*6+3], verts[idx*6+4], verts[idx*6+5]); };
@@ -35,45 +35,43 @@ class RayMesh : public Hittable {
             }
 
             buildBVH();
-            setTransform(transform);
         }
 
-        float sdf(const glm::vec3&) const override { return 0.0f; }
-
-        bool raymarch(const Ray& ray, HitRecord& rec) const override {
-            glm::vec3 o = glm::vec3(_modelMatrixI * glm::vec4(ray.origin(), 1.0f));
-            glm::vec3 d = glm::normalize(glm::vec3(_modelMatrixI * glm::vec4(ray.direction(), 0.0f)));
-
-            float tMin = 1e30f;
-            HitRecord tmpRec;
-            bool hit = false;
-
-            traverseBVH(0, o, d, tMin, tmpRec, hit);
+        void traverse(const glm::vec3& o, const glm::vec3& d, float& tMin, HitRecord& rec, bool& hit) const {
+            traverseBVH(0, o, d, tMin, rec, hit);
+        }
 
-            if (hit) {
-                tmpRec.point = glm::vec3(_modelMatrix * glm::vec4(tmpRec.point, 1.0f));
-                tmpRec.normal = glm::normalize(glm::vec3(_modelMatrixIT * glm::vec4(tmpRec.normal, 0.0f)));
-                tmpRec.setFaceNormal(ray, tmpRec.normal);
-                tmpRec.material = _material;
-                rec = tmpRec;
+        bool occluded(const glm::vec3& o, const glm::vec3& d, float tMax) const {
+            int stack[64];
+            int stackSize = 0;
+            stack[stackSize++] = 0;
+
+            while (stackSize > 0) {
+                const BVHNode& node = _bvh[stack[--stackSize]];
+                RenderStats::count(Counter::BVHNodes);
+                if (!aabbHit(node, o, d, tMax))
+                    continue;
+
+                if (node.triCount > 0) {
+                    RenderStats::count(Counter::Triangles, node.triCount);
+                    for (int i = node.triStart; i < node.triStart + node.triCount; i++) {
+                        if (occludes(_triangles[_leafTris[i]], o, d, tMax))
+                            return true;
+                    }
+                    continue;
+                }
+
+                if (stackSize < 63) {
+                    stack[stackSize++] = node.right;
+                    stack[stackSize++] = node.left;
+                }
             }
-
-            return hit;
+            return false;
         }
 
-        bool shadowMarch(const Ray& ray, float lightDist) const override {
-            glm::vec3 o = glm::vec3(_modelMatrixI * glm::vec4(ray.origin(), 1.0f));
-            glm::vec3 dLocal = glm::vec3(_modelMatrixI * glm::vec4(ray.direction(), 0.0f));
-            float localScale = glm::length(dLocal);
-            glm::vec3 d = glm::normalize(dLocal);
-            float localLightDist = lightDist * localScale;
-
-            float tMin = localLightDist;
-            HitRecord tmp;
-            bool hit = false;
-            traverseBVH(0, o, d, tMin, tmp, hit);
-            return hit;
-        }
+        size_t triangleCount() const { return _triangles.size(); }
+        glm::vec3 boundsMin() const { return _bvh.empty() ? glm::vec3(0.0f) : _bvh[0].boundsMin; }
+        glm::vec3 boundsMax() const { return _bvh.empty() ? glm::vec3(0.0f) : _bvh[0].boundsMax; }
     private:
         std::vector<Triangle> _triangles;
         std::vector<BVHNode> _bvh;
@@ -84,6 +82,8 @@ class RayMesh : public Hittable {
         void buildBVH() {
             std::vector<int> triIndices(_triangles.size());
             std::iota(triIndices.begin(), triIndices.end(), 0);
+            _bvh.reserve(std::max<size_t>(_triangles.size(), 1));
+            _leafTris.reserve(_triangles.size());
             _bvh.emplace_back();
             buildNode(0, triIndices, 0, triIndices.size());
         }
@@ -148,9 +148,11 @@ class RayMesh : public Hittable {
         void traverseBVH(int nodeIdx, const glm::vec3& o, const glm::vec3& d,
                          float& tMin, HitRecord& rec, bool& hit) const {
             const BVHNode& node = _bvh[nodeIdx];
+            RenderStats::count(Counter::BVHNodes);
             if (!aabbHit(node, o, d, tMin)) return;
 
             if (node.triCount > 0) {
+                RenderStats::count(Counter::Triangles, node.triCount);
                 for (int i = node.triStart; i < node.triStart + node.triCount; i++)
                     intersectTri(_triangles[_leafTris[i]], o, d, tMin, rec, hit);
                 return;
@@ -160,6 +162,28 @@ class RayMesh : public Hittable {
             traverseBVH(node.right, o, d, tMin, rec, hit);
         }
 
+        static bool occludes(const Triangle& tri, const glm::vec3& o, const glm::vec3& d, float tMax) {
+            const float EPSILON = 1e-7f;
+            glm::vec3 e1 = tri.v1 - tri.v0;
+            glm::vec3 e2 = tri.v2 - tri.v0;
+            glm::vec3 h = glm::cross(d, e2);
+            float det = glm::dot(e1, h);
+
+            if (fabs(det) < EPSILON) return false;
+
+            float invDet = 1.0f / det;
+            glm::vec3 s = o - tri.v0;
+            float u = glm::dot(s, h) * invDet;
+            if (u < 0.0f || u > 1.0f) return false;
+
+            glm::vec3 q = glm::cross(s, e1);
+            float v = glm::dot(d, q) * invDet;
+            if (v < 0.0f || u + v > 1.0f) return false;
+
+            float t = glm::dot(e2, q) * invDet;
+            return t >= EPSILON && t < tMax;
+        }
+
         void intersectTri(const Triangle& tri, const glm::vec3& o, const glm::vec3& d,
                           float& tMin, HitRecord& rec, bool& hit) const {
             const float EPSILON = 1e-7f;
@@ -190,4 +214,56 @@ class RayMesh : public Hittable {
         }
 };
 
+class RayMesh : public Hittable {
+    public:
+        RayMesh(Span<const float> verts, Span<const unsigned int> indices, const Transform& transform, std::shared_ptr<RayMaterial> material)
+            : RayMesh(std::make_shared<MeshBVH>(verts, indices), transform, material) {}
+
+        RayMesh(std::shared_ptr<const MeshBVH> mesh, const Transform& transform, std::shared_ptr<RayMaterial> material) : _mesh(std::move(mesh)) {
+            _material = material;
+            setTransform(transform);
+        }
+
+        float sdf(const glm::vec3&) const override { return 0.0f; }
+
+        bool raymarch(const Ray& ray, HitRecord& rec) const override {
+            glm::vec3 o = glm::vec3(_modelMatrixI * glm::vec4(ray.origin(), 1.0f));
+            glm::vec3 d = glm::normalize(glm::vec3(_modelMatrixI * glm::vec4(ray.direction(), 0.0f)));
+
+            float tMin = 1e30f;
+            HitRecord tmpRec;
+            bool hit = false;
+
+            _mesh->traverse(o, d, tMin, tmpRec, hit);
+
+            if (hit) {
+                tmpRec.point = glm::vec3(_modelMatrix * glm::vec4(tmpRec.point, 1.0f));
+                tmpRec.normal = glm::normalize(glm::vec3(_modelMatrixIT * glm::vec4(tmpRec.normal, 0.0f)));
+                tmpRec.setFaceNormal(ray, tmpRec.normal);
+                tmpRec.material = _material;
+                tmpRec.objectId = _objectId;
+                rec = tmpRec;
+            }
+
+            return hit;
+        }
+
+        bool shadowMarch(const Ray& ray, float lightDist) const override {
+            glm::vec3 o = glm::vec3(_modelMatrixI * glm::vec4(ray.origin(), 1.0f));
+            glm::vec3 dLocal = glm::vec3(_modelMatrixI * glm::vec4(ray.direction(), 0.0f));
+            float localScale = glm::length(dLocal);
+            glm::vec3 d = glm::normalize(dLocal);
+            float localLightDist = lightDist * localScale;
+
+            return _mesh->occluded(o, d, localLightDist);
+        }
+
+        const std::shared_ptr<const MeshBVH>& mesh() const { return _mesh; }
+    protected:
+        glm::vec3 localBoundsMin() const override { return _mesh->boundsMin(); }
+        glm::vec3 localBoundsMax() const override { return _mesh->boundsMax(); }
+    private:
+        std::shared_ptr<const MeshBVH> _mesh;
+};
+
 #endif
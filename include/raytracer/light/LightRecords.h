@@ -0,0 +1,144 @@
+#ifndef LIGHTRECORDS_H
+#define LIGHTRECORDS_H
+
+#include "RayLight.h"
+#include "../util/Simd.h"
+#include <vector>
+#include <memory>
+
+struct LightChoice {
+    int light;
+    float weight;
+};
+
+struct LightSample {
+    glm::vec3 direction;
+    float distance;
+    Color radiance;
+    bool finite;
+};
+
+class LightRecords {
+    public:
+        void clear() {
+            for (std::vector<float>* field : fields())
+                field->clear();
+            _count = 0;
+        }
+
+        void build(const std::vector<std::shared_ptr<RayLight>>& lights) {
+            clear();
+            _count = lights.size();
+            for (std::vector<float>* field : fields())
+                field->assign(_count, 0.0f);
+
+            for (size_t i = 0; i < _count; i++) {
+                LightRecord record = lights[i]->bake();
+                for (int axis = 0; axis < 3; axis++) {
+                    _position[axis][i] = record.position[axis];
+                    _direction[axis][i] = record.direction[axis];
+                    _radiance[axis][i] = record.radiance[axis];
+                }
+                _outerCutOff[i] = record.outerCutOff;
+                _inverseBlend[i] = record.inverseBlend;
+                _rangeSquared[i] = record.rangeSquared;
+                _cosCutOff[i] = record.cosCutOff;
+                _finite[i] = record.finite ? 1.0f : 0.0f;
+                _spot[i] = record.spot ? 1.0f : 0.0f;
+            }
+        }
+
+        bool built(size_t lightCount) const { return _count == lightCount; }
+        size_t size() const { return _count; }
+
+        bool reaches(int light, const glm::vec3& point) const {
+            glm::vec3 offset = point - glm::vec3(_position[0][light], _position[1][light], _position[2][light]);
+            float distanceSquared = glm::dot(offset, offset);
+            if (distanceSquared > _rangeSquared[light])
+                return false;
+            if (distanceSquared == 0.0f || _cosCutOff[light] <= -1.0f)
+                return true;
+            glm::vec3 axis(_direction[0][light], _direction[1][light], _direction[2][light]);
+            return glm::dot(offset, axis) >= _cosCutOff[light] * std::sqrt(distanceSquared);
+        }
+
+        void evaluate(const glm::vec3& point, const LightChoice* choices, int count, LightSample* samples) const {
+            for (int first = 0; first < count; first += Float4::width) {
+                int lanes = std::min(count - first, Float4::width);
+                int indices[Float4::width];
+                bool contiguous = true;
+                for (int lane = 0; lane < Float4::width; lane++) {
+                    indices[lane] = lane < lanes ? choices[first + lane].light : choices[first].light;
+                    contiguous = contiguous && indices[lane] == indices[0] + lane;
+                }
+
+                auto load = [&](const std::vector<float>& field) {
+                    if (contiguous)
+                        return Float4::load(field.data() + indices[0]);
+                    float values[Float4::width];
+                    for (int lane = 0; lane < Float4::width; lane++)
+                        values[lane] = field[indices[lane]];
+                    return Float4::load(values);
+                };
+
+                Float4 finite = Float4(0.0f) < load(_finite);
+                Float4 spot = Float4(0.0f) < load(_spot);
+
+                Float4 toLight[3];
+                for (int axis = 0; axis < 3; axis++)
+                    toLight[axis] = load(_position[axis]) - Float4(point[axis]);
+                Float4 distance = sqrt(toLight[0] * toLight[0] + toLight[1] * toLight[1] + toLight[2] * toLight[2]);
+                Float4 inverseDistance = Float4(1.0f) / distance;
+
+                Float4 axisDir[3], lightDir[3];
+                for (int axis = 0; axis < 3; axis++) {
+                    axisDir[axis] = load(_direction[axis]);
+                    lightDir[axis] = select(finite, toLight[axis] * inverseDistance, axisDir[axis]);
+                }
+
+                Float4 attenuation = select(finite, Float4(1.0f) / (Float4(1.0f) + Float4(RayLight::linearFalloff) * distance + Float4(RayLight::quadraticFalloff) * distance * distance), Float4(1.0f));
+
+                Float4 theta = Float4(0.0f) - (lightDir[0] * axisDir[0] + lightDir[1] * axisDir[1] + lightDir[2] * axisDir[2]);
+                theta = max(min(theta, Float4(1.0f)), Float4(-1.0f));
+                Float4 outerCutOff = load(_outerCutOff);
+                Float4 angle = acos(theta);
+                Float4 spotIntensity = max(min((angle - outerCutOff) * load(_inverseBlend), Float4(1.0f)), Float4(0.0f));
+                spotIntensity = select(outerCutOff < angle, Float4(0.0f), spotIntensity);
+                attenuation = attenuation * select(spot, spotIntensity, Float4(1.0f));
+
+                float out[8][Float4::width];
+                for (int axis = 0; axis < 3; axis++) {
+                    lightDir[axis].store(out[axis]);
+                    (load(_radiance[axis]) * attenuation).store(out[3 + axis]);
+                }
+                distance.store(out[6]);
+                load(_finite).store(out[7]);
+
+                for (int lane = 0; lane < lanes; lane++) {
+                    LightSample& sample = samples[first + lane];
+                    sample.direction = glm::vec3(out[0][lane], out[1][lane], out[2][lane]);
+                    sample.radiance = Color(out[3][lane], out[4][lane], out[5][lane]);
+                    sample.finite = out[7][lane] > 0.0f;
+                    sample.distance = sample.finite ? out[6][lane] : infinity;
+                }
+            }
+        }
+    private:
+        std::vector<float> _position[3];
+        std::vector<float> _direction[3];
+        std::vector<float> _radiance[3];
+        std::vector<float> _outerCutOff;
+        std::vector<float> _inverseBlend;
+        std::vector<float> _rangeSquared;
+        std::vector<float> _cosCutOff;
+        std::vector<float> _finite;
+        std::vector<float> _spot;
+        size_t _count = 0;
+
+        std::vector<std::vector<float>*> fields() {
+            return {&_position[0], &_position[1], &_position[2], &_direction[0], &_direction[1], &_direction[2],
+                    &_radiance[0], &_radiance[1], &_radiance[2], &_outerCutOff, &_inverseBlend, &_rangeSquared, &_cosCutOff, &_finite, &_spot};
+        }
+};
+
+#endif
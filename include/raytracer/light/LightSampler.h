@@ -0,0 +1,86 @@
+#ifndef LIGHTSAMPLER_H
+#define LIGHTSAMPLER_H
+
+#include "RayLightList.h"
+#include <vector>
+#include <algorithm>
+
+enum class LightSelection {
+    All,
+    Power,
+    Nearby,
+    Tree,
+    END
+};
+
+inline constexpr const char* lightSelectionNames[] = { "All lights", "By power", "Nearby lights", "Light tree" };
+
+class LightSampler {
+    public:
+        static void select(const RayLightList& lights, const glm::vec3& point, LightSelection selection, int count, std::vector<LightChoice>& choices) {
+            choices.clear();
+            int lightCount = (int)lights.lights.size();
+            bool built = lights.tree.built(lights.lights.size()) && lights.records.built(lights.lights.size());
+            if ((selection == LightSelection::Nearby || selection == LightSelection::Tree) && !built)
+                selection = selection == LightSelection::Nearby ? LightSelection::All : LightSelection::Power;
+
+            if (selection == LightSelection::All || (selection == LightSelection::Power && lightCount <= count)) {
+                for (int i = 0; i < lightCount; i++)
+                    choices.push_back({i, 1.0f});
+                return;
+            }
+
+            if (selection == LightSelection::Nearby || selection == LightSelection::Tree) {
+                for (int i : lights.tree.unbounded())
+                    choices.push_back({i, 1.0f});
+
+                if (selection == LightSelection::Nearby) {
+                    lights.tree.collect(point, [&](int i) {
+                        if (lights.records.reaches(i, point))
+                            choices.push_back({i, 1.0f});
+                    });
+                    return;
+                }
+
+                for (int c = 0; c < count; c++) {
+                    int i;
+                    float pdf;
+                    if (lights.tree.sample(point, randomFloat(), i, pdf) && lights.records.reaches(i, point))
+                        choices.push_back({i, 1.0f / (pdf * float(count))});
+                }
+                return;
+            }
+
+            static thread_local std::vector<LightChoice> all;
+            static thread_local std::vector<LightSample> samples;
+            static thread_local std::vector<float> cdf;
+            all.resize(lightCount);
+            for (int i = 0; i < lightCount; i++)
+                all[i] = {i, 1.0f};
+            lights.evaluate(point, all, samples);
+
+            cdf.resize(lightCount);
+            float total = 0.0f;
+            for (int i = 0; i < lightCount; i++) {
+                const Color& intensity = samples[i].radiance;
+                total += std::max(intensity.r + intensity.g + intensity.b, 0.0f);
+                cdf[i] = total;
+            }
+
+            if (total <= 0.0f)
+                return;
+
+            for (int c = 0; c < count; c++) {
+                float u = randomFloat() * total;
+                int i = int(std::upper_bound(cdf.begin(), cdf.end(), u) - cdf.begin());
+                i = std::min(i, lightCount - 1);
+                while (i > 0 && cdf[i] == cdf[i - 1])
+                    i--;
+
+                float pdf = (cdf[i] - (i > 0 ? cdf[i - 1] : 0.0f)) / total;
+                choices.push_back({i, 1.0f / (pdf * float(count))});
+            }
+        }
+};
+
+#endif
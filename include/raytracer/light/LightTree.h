@@ -0,0 +1,175 @@
+#ifndef LIGHTTREE_H
+#define LIGHTTREE_H
+
+#include "RayLight.h"
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+class LightTree {
+    public:
+        void clear() {
+            _nodes.clear();
+            _entries.clear();
+            _unbounded.clear();
+            _lightCount = 0;
+        }
+
+        void build(const std::vector<std::shared_ptr<RayLight>>& lights) {
+            clear();
+            _lightCount = lights.size();
+            for (int i = 0; i < (int)lights.size(); i++) {
+                LightEntry entry;
+                entry.light = i;
+                if (!lights[i]->bounds(entry.boundsMin, entry.boundsMax)) {
+                    _unbounded.push_back(i);
+                    continue;
+                }
+                entry.position = lights[i]->transform().position;
+                entry.power = lights[i]->power();
+                if (entry.power > 0.0f)
+                    _entries.push_back(entry);
+            }
+
+            if (_entries.empty())
+                return;
+            _nodes.reserve(_entries.size() * 2);
+            _nodes.emplace_back();
+            buildNode(0, 0, (int)_entries.size());
+        }
+
+        bool built(size_t lightCount) const { return _lightCount == lightCount; }
+        const std::vector<int>& unbounded() const { return _unbounded; }
+
+        template<typename Visit>
+        void collect(const glm::vec3& point, Visit&& visit) const {
+            if (_nodes.empty())
+                return;
+
+            int stack[64];
+            int stackSize = 0;
+            stack[stackSize++] = 0;
+            while (stackSize > 0) {
+                const LightNode& node = _nodes[stack[--stackSize]];
+                if (!contains(node.boundsMin, node.boundsMax, point))
+                    continue;
+
+                if (node.entry >= 0) {
+                    visit(_entries[node.entry].light);
+                } else {
+                    stack[stackSize++] = node.left;
+                    stack[stackSize++] = node.right;
+                }
+            }
+        }
+
+        bool sample(const glm::vec3& point, float u, int& light, float& pdf) const {
+            if (_nodes.empty())
+                return false;
+
+            int index = 0;
+            pdf = 1.0f;
+            u = std::min(u, 1.0f - epsilon);
+            if (importance(_nodes[0], point) <= 0.0f)
+                return false;
+
+            while (_nodes[index].entry < 0) {
+                const LightNode& node = _nodes[index];
+                float left = importance(_nodes[node.left], point);
+                float right = importance(_nodes[node.right], point);
+                if (left + right <= 0.0f)
+                    return false;
+
+                float probability = left / (left + right);
+                if (u < probability) {
+                    u = std::min(u / probability, 1.0f - epsilon);
+                    pdf *= probability;
+                    index = node.left;
+                } else {
+                    u = std::min((u - probability) / (1.0f - probability), 1.0f - epsilon);
+                    pdf *= 1.0f - probability;
+                    index = node.right;
+                }
+            }
+
+            light = _entries[_nodes[index].entry].light;
+            return pdf > 0.0f;
+        }
+    private:
+        struct LightEntry {
+            int light;
+            glm::vec3 position;
+            glm::vec3 boundsMin;
+            glm::vec3 boundsMax;
+            float power;
+        };
+
+        struct LightNode {
+            glm::vec3 boundsMin;
+            glm::vec3 boundsMax;
+            glm::vec3 positionMin;
+            glm::vec3 positionMax;
+            float power = 0.0f;
+            int left = -1;
+            int right = -1;
+            int entry = -1;
+        };
+
+        static constexpr float epsilon = 1e-6f;
+
+        std::vector<LightNode> _nodes;
+        std::vector<LightEntry> _entries;
+        std::vector<int> _unbounded;
+        size_t _lightCount = 0;
+
+        static bool contains(const glm::vec3& boundsMin, const glm::vec3& boundsMax, const glm::vec3& point) {
+            return point.x >= boundsMin.x && point.y >= boundsMin.y && point.z >= boundsMin.z &&
+                   point.x <= boundsMax.x && point.y <= boundsMax.y && point.z <= boundsMax.z;
+        }
+
+        static float importance(const LightNode& node, const glm::vec3& point) {
+            if (!contains(node.boundsMin, node.boundsMax, point))
+                return 0.0f;
+
+            glm::vec3 offset = glm::max(glm::max(node.positionMin - point, point - node.positionMax), glm::vec3(0.0f));
+            return node.power * RayLight::attenuation(glm::length(offset));
+        }
+
+        void buildNode(int nodeIdx, int start, int end) {
+            LightNode node;
+            node.boundsMin = glm::vec3(infinity);
+            node.boundsMax = glm::vec3(-infinity);
+            node.positionMin = glm::vec3(infinity);
+            node.positionMax = glm::vec3(-infinity);
+            for (int i = start; i < end; i++) {
+                node.boundsMin = glm::min(node.boundsMin, _entries[i].boundsMin);
+                node.boundsMax = glm::max(node.boundsMax, _entries[i].boundsMax);
+                node.positionMin = glm::min(node.positionMin, _entries[i].position);
+                node.positionMax = glm::max(node.positionMax, _entries[i].position);
+                node.power += _entries[i].power;
+            }
+
+            if (end - start == 1) {
+                node.entry = start;
+                _nodes[nodeIdx] = node;
+                return;
+            }
+
+            glm::vec3 extent = node.positionMax - node.positionMin;
+            int axis = (extent.x > extent.y && extent.x > extent.z) ? 0 : (extent.y > extent.z ? 1 : 2);
+
+            int mid = (start + end) / 2;
+            std::nth_element(_entries.begin() + start, _entries.begin() + mid, _entries.begin() + end, [&](const LightEntry& a, const LightEntry& b) {
+                return a.position[axis] < b.position[axis];
+            });
+
+            node.left = (int)_nodes.size(); _nodes.emplace_back();
+            node.right = (int)_nodes.size(); _nodes.emplace_back();
+            _nodes[nodeIdx] = node;
+
+            buildNode(node.left, start, mid);
+            buildNode(node.right, mid, end);
+        }
+};
+
+#endif
@@ -3,6 +3,19 @@
 
 #include "../util/RaytracerUtils.h"
 #include "../../editor/entity/util/Transform.h"
+#include <glm/gtx/component_wise.hpp>
+
+struct LightRecord {
+    glm::vec3 position{0.0f};
+    glm::vec3 direction{0.0f, 0.0f, -1.0f};
+    Color radiance{0.0f};
+    float outerCutOff = glm::pi<float>();
+    float inverseBlend = -1.0f;
+    float rangeSquared = infinity;
+    float cosCutOff = -1.0f;
+    bool finite = false;
+    bool spot = false;
+};
 
 class RayLight {
     public:
@@ -18,6 +31,37 @@ class RayLight {
             return infinity;
         }
 
+        virtual bool bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const {
+            return false;
+        }
+
+        virtual LightRecord bake() const {
+            LightRecord record;
+            record.position = _transform.position;
+            record.radiance = _color * _intensity;
+            record.finite = isFinite();
+            return record;
+        }
+
+        float power() const {
+            return (_color.r + _color.g + _color.b) * _intensity;
+        }
+
+        static float attenuation(float distance) {
+            return 1.0f / (1.0f + linearFalloff * distance + quadraticFalloff * (distance * distance));
+        }
+
+        static float range(float peak) {
+            float falloff = peak / influenceCutoff - 1.0f;
+            if (falloff <= 0.0f)
+                return 0.0f;
+            return (-linearFalloff + std::sqrt(linearFalloff * linearFalloff + 4.0f * quadraticFalloff * falloff)) / (2.0f * quadraticFalloff);
+        }
+
+        static constexpr float linearFalloff = 0.09f;
+        static constexpr float quadraticFalloff = 0.032f;
+        static constexpr float influenceCutoff = 1.0f / 1024.0f;
+
         Color& color() { return _color; }
         float& intensity() { return _intensity; }
         Transform& transform() { return _transform; }
@@ -46,6 +90,12 @@ class RayDirectionalLight : public RayLight {
         bool isFinite() const override {
             return false;
         }
+
+        LightRecord bake() const override {
+            LightRecord record = RayLight::bake();
+            record.direction = -getDirection();
+            return record;
+        }
     private:
         glm::vec3 getDirection() const {
             glm::quat rotationQuat = glm::quat(glm::yawPitchRoll(
@@ -72,22 +122,34 @@ class RayPointLight : public RayLight {
 
         Color intensityAt(const glm::vec3& point) const override {
             float distance = glm::length(_transform.position - point);
-            float attenuation = 1.0f / (_constant + _linear * distance + _quadratic * (distance * distance));
-
-            return _color * _intensity * attenuation;
+            return _color * _intensity * attenuation(distance);
         }
 
         float distanceFrom(const glm::vec3& point) const override {
             return glm::length(_transform.position - point);
         }
 
+        bool bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const override {
+            float radius = range(peakIntensity());
+            boundsMin = _transform.position - glm::vec3(radius);
+            boundsMax = _transform.position + glm::vec3(radius);
+            return true;
+        }
+
+        LightRecord bake() const override {
+            LightRecord record = RayLight::bake();
+            float radius = range(peakIntensity());
+            record.rangeSquared = radius * radius;
+            return record;
+        }
+
         bool isFinite() const override {
             return true;
         }
     private:
-        float _constant = 1.0f;
-        float _linear = 0.09f;
-        float _quadratic = 0.032f;
+        float peakIntensity() const {
+            return glm::compMax(_color) * _intensity;
+        }
 };
 
 class RaySpotLight : public RayLight {
@@ -119,23 +181,50 @@ class RaySpotLight : public RayLight {
             float spotIntensity = glm::clamp((angle - outerCutOff) / epsilon, 0.0f, 1.0f);
 
             float distance = glm::length(_transform.position - point);
-            float attenuation = 1.0f / (_constant + _linear * distance + _quadratic * (distance * distance));
-
-            return _color * _intensity * attenuation * spotIntensity;
+            return _color * _intensity * attenuation(distance) * spotIntensity;
         }
 
         float distanceFrom(const glm::vec3& point) const override {
             return glm::length(_transform.position - point);
         }
 
+        bool bounds(glm::vec3& boundsMin, glm::vec3& boundsMax) const override {
+            float radius = range(glm::compMax(_color) * _intensity);
+            float outerCutOff = glm::min(glm::radians(_size * 0.5f), glm::pi<float>());
+            glm::vec3 axis = getDirection();
+
+            glm::vec3 capCenter = _transform.position + axis * (radius * std::cos(outerCutOff));
+            glm::vec3 capExtent = radius * std::sin(outerCutOff) * glm::sqrt(glm::max(1.0f - axis * axis, 0.0f));
+            boundsMin = glm::min(_transform.position, capCenter - capExtent);
+            boundsMax = glm::max(_transform.position, capCenter + capExtent);
+
+            float cosCutOff = std::cos(outerCutOff);
+            for (int i = 0; i < 3; i++) {
+                if (axis[i] >= cosCutOff)
+                    boundsMax[i] = _transform.position[i] + radius;
+                if (-axis[i] >= cosCutOff)
+                    boundsMin[i] = _transform.position[i] - radius;
+            }
+            return true;
+        }
+
+        LightRecord bake() const override {
+            LightRecord record = RayLight::bake();
+            float outerCutOff = glm::radians(_size * 0.5f);
+            record.direction = getDirection();
+            record.outerCutOff = outerCutOff;
+            record.inverseBlend = 1.0f / (outerCutOff * (1.0f - _blend) - outerCutOff);
+            float radius = range(glm::compMax(_color) * _intensity);
+            record.rangeSquared = radius * radius;
+            record.cosCutOff = std::cos(outerCutOff);
+            record.spot = true;
+            return record;
+        }
+
         bool isFinite() const override {
             return true;
         }
     private:
-        float _constant = 1.0f;
-        float _linear = 0.09f;
-        float _quadratic = 0.032f;
-
         float _size = 45.0f;
         float _blend = 0.15f;
 
@@ -2,19 +2,48 @@
 #define RAYLIGHTLIST_H
 
 #include "RayLight.h"
+#include "LightTree.h"
+#include "LightRecords.h"
 
 class RayLightList {
     public:
         std::vector<std::shared_ptr<RayLight>> lights;
+        LightTree tree;
+        LightRecords records;
 
         RayLightList() {}
         RayLightList(std::shared_ptr<RayLight> light) { add(light); }
 
-        void clear() { lights.clear(); }
+        void clear() {
+            lights.clear();
+            tree.clear();
+            records.clear();
+        }
 
         void add(std::shared_ptr<RayLight> light) {
             lights.push_back(light);
         }
+
+        void build() {
+            tree.build(lights);
+            records.build(lights);
+        }
+
+        void evaluate(const glm::vec3& point, const std::vector<LightChoice>& choices, std::vector<LightSample>& samples) const {
+            samples.resize(choices.size());
+            if (records.built(lights.size())) {
+                records.evaluate(point, choices.data(), (int)choices.size(), samples.data());
+                return;
+            }
+
+            for (size_t i = 0; i < choices.size(); i++) {
+                const RayLight& light = *lights[choices[i].light];
+                samples[i].direction = glm::normalize(light.directionFrom(point));
+                samples[i].distance = light.distanceFrom(point);
+                samples[i].radiance = light.intensityAt(point);
+                samples[i].finite = light.isFinite();
+            }
+        }
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,164 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include "../util/RenderBuffers.h"
+
+#if !defined(_WIN32)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+class Checkpoint {
+    public:
+        struct Header {
+            int width = 0;
+            int height = 0;
+            uint64_t sceneHash = 0;
+            uint64_t samplerSeed = 0;
+            uint32_t samplerPass = 0;
+        };
+
+        static bool write(const std::string& path, const Header& header, RenderBuffers& buffers) {
+            std::string temporary = path + ".tmp";
+            {
+                std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+                if (!file)
+                    return false;
+
+                file.write(_magic, sizeof(_magic));
+                writeValue(file, _version);
+                writeValue(file, header);
+
+                for (const Chunk& chunk : chunks(buffers)) {
+                    uint32_t nameLength = (uint32_t)std::strlen(chunk.name);
+                    writeValue(file, nameLength);
+                    file.write(chunk.name, nameLength);
+                    writeValue(file, (uint64_t)chunk.bytes);
+                    file.write(static_cast<const char*>(chunk.data), chunk.bytes);
+                }
+
+                file.flush();
+                if (!file.good()) {
+                    file.close();
+                    discard(temporary);
+                    return false;
+                }
+            }
+
+            if (!sync(temporary)) {
+                discard(temporary);
+                return false;
+            }
+
+            std::error_code error;
+            std::filesystem::rename(temporary, path, error);
+            if (error) {
+                discard(temporary);
+                return false;
+            }
+
+            std::filesystem::path directory = std::filesystem::path(path).parent_path();
+            sync(directory.empty() ? "." : directory.string());
+            return true;
+        }
+
+        static bool readHeader(const std::string& path, Header& header) {
+            std::ifstream file(path, std::ios::binary);
+            return file && readPreamble(file, header);
+        }
+
+        static bool read(const std::string& path, RenderBuffers& buffers) {
+            std::ifstream file(path, std::ios::binary);
+            Header header;
+            if (!file || !readPreamble(file, header))
+                return false;
+            if (header.width != buffers.width() || header.height != buffers.height())
+                return false;
+
+            std::vector<Chunk> targets = chunks(buffers);
+            std::vector<bool> loaded(targets.size(), false);
+            uint32_t nameLength;
+            while (file.read(reinterpret_cast<char*>(&nameLength), sizeof(nameLength))) {
+                std::string name(nameLength, '\0');
+                uint64_t bytes = 0;
+                file.read(name.data(), nameLength);
+                file.read(reinterpret_cast<char*>(&bytes), sizeof(bytes));
+                if (!file)
+                    return false;
+
+                auto target = std::find_if(targets.begin(), targets.end(), [&](const Chunk& chunk) {
+                    return name == chunk.name && bytes == chunk.bytes;
+                });
+
+                if (target != targets.end()) {
+                    file.read(static_cast<char*>(target->data), bytes);
+                    loaded[target - targets.begin()] = true;
+                } else {
+                    file.seekg(bytes, std::ios::cur);
+                }
+
+                if (!file)
+                    return false;
+            }
+
+            return std::all_of(loaded.begin(), loaded.end(), [](bool chunk) { return chunk; });
+        }
+    private:
+        static constexpr char _magic[8] = {'R', 'A', 'D', 'C', 'K', 'P', 'T', '\0'};
+        static constexpr uint32_t _version = 1;
+
+        struct Chunk {
+            const char* name;
+            void* data;
+            size_t bytes;
+        };
+
+        static std::vector<Chunk> chunks(RenderBuffers& buffers) {
+            size_t pixelCount = buffers.pixelCount();
+            std::vector<Chunk> result;
+            for (const BufferChannel& channel : buffers.channels())
+                result.push_back({channel.name, channel.data, channel.elementSize * pixelCount});
+            return result;
+        }
+
+        static bool sync(const std::string& path) {
+#if !defined(_WIN32)
+            int descriptor = ::open(path.c_str(), O_RDONLY);
+            if (descriptor < 0)
+                return false;
+            bool synced = ::fsync(descriptor) == 0;
+            ::close(descriptor);
+            return synced;
+#else
+            return true;
+#endif
+        }
+
+        static void discard(const std::string& path) {
+            std::error_code error;
+            std::filesystem::remove(path, error);
+        }
+
+        template<typename T>
+        static void writeValue(std::ofstream& file, const T& value) {
+            file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        static bool readPreamble(std::ifstream& file, Header& header) {
+            char magic[sizeof(_magic)];
+            uint32_t version = 0;
+            file.read(magic, sizeof(magic));
+            file.read(reinterpret_cast<char*>(&version), sizeof(version));
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            return file && std::memcmp(magic, _magic, sizeof(_magic)) == 0 && version == _version;
+        }
+};
+
+#endif
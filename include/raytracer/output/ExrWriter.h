@@ -0,0 +1,191 @@
+#ifndef EXRWRITER_H
+#define EXRWRITER_H
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+class ExrWriter {
+    public:
+        ExrWriter(int width, int height) : _width(width), _height(height) {}
+
+        void addChannel(const std::string& name, const float* data, int stride) {
+            _channels.push_back({name, data, nullptr, stride});
+        }
+
+        void addChannel(const std::string& name, const int* data, int stride) {
+            _channels.push_back({name, nullptr, data, stride});
+        }
+
+        bool write(const std::string& path) const {
+            std::vector<Channel> channels = _channels;
+            std::sort(channels.begin(), channels.end(), [](const Channel& a, const Channel& b) {
+                return std::strcmp(a.name.c_str(), b.name.c_str()) < 0;
+            });
+
+            std::vector<std::string> names;
+            for (const Channel& channel : channels)
+                names.push_back(channel.name);
+
+            std::ofstream file(path, std::ios::binary);
+            if (!file)
+                return false;
+            writeHeader(file, names);
+
+            std::vector<float> row(size_t(_width) * channels.size());
+            for (int y = 0; y < _height; y++) {
+                int sourceRow = _height - 1 - y;
+
+                float* out = row.data();
+                for (const Channel& channel : channels) {
+                    for (int x = 0; x < _width; x++) {
+                        size_t index = (size_t(sourceRow) * _width + x) * channel.stride;
+                        *out++ = channel.floatData ? channel.floatData[index] : float(channel.intData[index]);
+                    }
+                }
+
+                writeBlock(file, y, row);
+            }
+
+            return file.good();
+        }
+
+        bool begin(const std::string& path, const std::vector<std::string>& names) {
+            _order.resize(names.size());
+            for (size_t i = 0; i < names.size(); i++)
+                _order[i] = (int)i;
+            std::sort(_order.begin(), _order.end(), [&](int a, int b) {
+                return std::strcmp(names[a].c_str(), names[b].c_str()) < 0;
+            });
+
+            std::vector<std::string> sorted;
+            for (int i : _order)
+                sorted.push_back(names[i]);
+
+            _file.open(path, std::ios::binary);
+            if (!_file)
+                return false;
+
+            writeHeader(_file, sorted);
+            _row.resize(size_t(_width) * names.size());
+            _nextRow = 0;
+            return _file.good();
+        }
+
+        bool writeRow(const float* pixels) {
+            size_t channelCount = _order.size();
+            float* out = _row.data();
+            for (int c : _order) {
+                for (int x = 0; x < _width; x++)
+                    *out++ = pixels[size_t(x) * channelCount + c];
+            }
+
+            writeBlock(_file, _nextRow++, _row);
+            return _file.good();
+        }
+
+        bool end() {
+            _file.close();
+            return _nextRow == _height && !_file.fail();
+        }
+    private:
+        struct Channel {
+            std::string name;
+            const float* floatData;
+            const int* intData;
+            int stride;
+        };
+
+        int _width;
+        int _height;
+        std::vector<Channel> _channels;
+
+        std::ofstream _file;
+        std::vector<int> _order;
+        std::vector<float> _row;
+        int _nextRow = 0;
+
+        void writeHeader(std::ofstream& file, const std::vector<std::string>& names) const {
+            std::vector<char> header;
+            writeInt(header, 20000630);
+            writeInt(header, 2);
+
+            std::vector<char> chlist;
+            for (const std::string& name : names) {
+                writeString(chlist, name);
+                writeInt(chlist, 2);
+                chlist.insert(chlist.end(), {0, 0, 0, 0});
+                writeInt(chlist, 1);
+                writeInt(chlist, 1);
+            }
+            chlist.push_back(0);
+            writeAttribute(header, "channels", "chlist", chlist);
+
+            writeAttribute(header, "compression", "compression", std::vector<char>{0});
+
+            std::vector<char> box;
+            writeInt(box, 0);
+            writeInt(box, 0);
+            writeInt(box, _width - 1);
+            writeInt(box, _height - 1);
+            writeAttribute(header, "dataWindow", "box2i", box);
+            writeAttribute(header, "displayWindow", "box2i", box);
+
+            writeAttribute(header, "lineOrder", "lineOrder", std::vector<char>{0});
+
+            std::vector<char> one;
+            writeFloat(one, 1.0f);
+            writeAttribute(header, "pixelAspectRatio", "float", one);
+            writeAttribute(header, "screenWindowWidth", "float", one);
+
+            std::vector<char> center;
+            writeFloat(center, 0.0f);
+            writeFloat(center, 0.0f);
+            writeAttribute(header, "screenWindowCenter", "v2f", center);
+
+            header.push_back(0);
+            file.write(header.data(), header.size());
+
+            uint64_t blockSize = 8 + uint64_t(_width) * names.size() * sizeof(float);
+            uint64_t firstBlock = header.size() + uint64_t(_height) * sizeof(uint64_t);
+            for (int y = 0; y < _height; y++) {
+                uint64_t offset = firstBlock + uint64_t(y) * blockSize;
+                file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+            }
+        }
+
+        static void writeBlock(std::ofstream& file, int y, const std::vector<float>& row) {
+            int32_t lineY = y;
+            int32_t dataSize = int32_t(row.size() * sizeof(float));
+            file.write(reinterpret_cast<const char*>(&lineY), sizeof(lineY));
+            file.write(reinterpret_cast<const char*>(&dataSize), sizeof(dataSize));
+            file.write(reinterpret_cast<const char*>(row.data()), dataSize);
+        }
+
+        static void writeInt(std::vector<char>& out, int32_t value) {
+            const char* p = reinterpret_cast<const char*>(&value);
+            out.insert(out.end(), p, p + sizeof(value));
+        }
+
+        static void writeFloat(std::vector<char>& out, float value) {
+            const char* p = reinterpret_cast<const char*>(&value);
+            out.insert(out.end(), p, p + sizeof(value));
+        }
+
+        static void writeString(std::vector<char>& out, const std::string& value) {
+            out.insert(out.end(), value.begin(), value.end());
+            out.push_back(0);
+        }
+
+        static void writeAttribute(std::vector<char>& out, const std::string& name, const std::string& type, const std::vector<char>& value) {
+            writeString(out, name);
+            writeString(out, type);
+            writeInt(out, (int32_t)value.size());
+            out.insert(out.end(), value.begin(), value.end());
+        }
+};
+
+#endif
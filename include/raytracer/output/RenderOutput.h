@@ -0,0 +1,91 @@
+#ifndef RENDEROUTPUT_H
+#define RENDEROUTPUT_H
+
+#include <stb_image_write.h>
+#include "ExrWriter.h"
+#include "../util/RenderBuffers.h"
+
+struct RenderLayer {
+    std::string name;
+    const float* floatData;
+    const int* intData;
+    int stride;
+
+    float value(int index) const {
+        return floatData ? floatData[size_t(index) * stride] : float(intData[size_t(index) * stride]);
+    }
+};
+
+class RenderOutput {
+    public:
+        static std::vector<RenderLayer> layers(const RenderBuffers& buffers, bool denoised) {
+            std::vector<RenderLayer> result;
+            const AOVSettings& aovs = buffers.aovs();
+
+            addVector(result, "", denoised ? buffers.denoised : buffers.color, "RGB");
+            if (denoised)
+                addVector(result, "noisy.", buffers.color, "RGB");
+
+            if (aovs.depth)
+                result.push_back({"Z", buffers.depth.data(), nullptr, 1});
+            if (aovs.normal)
+                addVector(result, "normal.", buffers.normal, "XYZ");
+            if (aovs.albedo)
+                addVector(result, "albedo.", buffers.albedo, "RGB");
+            if (aovs.sampleCount)
+                result.push_back({"sampleCount", nullptr, buffers.sampleCount.data(), 1});
+            if (!buffers.objectId.empty())
+                result.push_back({"objectId", nullptr, buffers.objectId.data(), 1});
+            if (!buffers.materialId.empty())
+                result.push_back({"materialId", nullptr, buffers.materialId.data(), 1});
+            if (!buffers.direct.empty())
+                addVector(result, "direct.", buffers.direct, "RGB");
+            if (!buffers.indirect.empty())
+                addVector(result, "indirect.", buffers.indirect, "RGB");
+            if (!buffers.costTime.empty()) {
+                result.push_back({"cost.time", buffers.costTime.data(), nullptr, 1});
+                result.push_back({"cost.bvhNodes", buffers.costNodes.data(), nullptr, 1});
+                result.push_back({"cost.sdfSteps", buffers.costSteps.data(), nullptr, 1});
+            }
+
+            return result;
+        }
+
+        static bool saveLayers(const std::string& path, const RenderBuffers& buffers, bool denoised) {
+            ExrWriter exr(buffers.window().width(), buffers.window().height());
+            for (const RenderLayer& layer : layers(buffers, denoised)) {
+                if (layer.floatData)
+                    exr.addChannel(layer.name, layer.floatData, layer.stride);
+                else
+                    exr.addChannel(layer.name, layer.intData, layer.stride);
+            }
+
+            return exr.write(path);
+        }
+
+        static bool saveHDR(const std::string& path, const RenderBuffers& buffers, bool denoised) {
+            const BufferVector<Color>& image = denoised ? buffers.denoised : buffers.color;
+
+            stbi_flip_vertically_on_write(true);
+            return stbi_write_hdr(path.c_str(), buffers.window().width(), buffers.window().height(), 3, &image[0].x) != 0;
+        }
+
+        static bool savePFM(const std::string& path, const RenderBuffers& buffers, bool denoised) {
+            const BufferVector<Color>& image = denoised ? buffers.denoised : buffers.color;
+
+            std::ofstream file(path, std::ios::binary);
+            if (!file)
+                return false;
+
+            file << "PF\n" << buffers.window().width() << " " << buffers.window().height() << "\n-1.0\n";
+            file.write(reinterpret_cast<const char*>(&image[0].x), image.size() * sizeof(Color));
+            return file.good();
+        }
+    private:
+        static void addVector(std::vector<RenderLayer>& layers, const std::string& layer, const BufferVector<glm::vec3>& data, const char* components) {
+            for (int c = 0; c < 3; c++)
+                layers.push_back({layer + components[c], &data[0][c], nullptr, 3});
+        }
+};
+
+#endif
@@ -0,0 +1,150 @@
+#ifndef TILEFILE_H
+#define TILEFILE_H
+
+#include "../util/RenderBuffers.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+class TileFile {
+    public:
+        bool create(const std::string& path, int width, int height, int tileSize, const std::vector<std::string>& channels) {
+            _file.close();
+            _file.open(path, std::ios::binary | std::ios::in | std::ios::out | std::ios::trunc);
+            if (!_file)
+                return false;
+
+            setLayout(width, height, tileSize, channels);
+
+            _file.write(_magic, sizeof(_magic));
+            writeValue(_version);
+            writeValue(int32_t(width));
+            writeValue(int32_t(height));
+            writeValue(int32_t(tileSize));
+            writeValue(uint32_t(channels.size()));
+            for (const std::string& name : channels) {
+                writeValue(uint32_t(name.size()));
+                _file.write(name.data(), name.size());
+            }
+
+            _dataOffset = uint64_t(_file.tellp());
+            _written.assign(size_t(_tilesX) * _tilesY, false);
+            return _file.good();
+        }
+
+        bool open(const std::string& path) {
+            _file.close();
+            _file.open(path, std::ios::binary | std::ios::in);
+            if (!_file)
+                return false;
+
+            char magic[sizeof(_magic)];
+            uint32_t version = 0, channelCount = 0;
+            int32_t width = 0, height = 0, tileSize = 0;
+            _file.read(magic, sizeof(magic));
+            readValue(version);
+            readValue(width);
+            readValue(height);
+            readValue(tileSize);
+            readValue(channelCount);
+            if (!_file || std::memcmp(magic, _magic, sizeof(_magic)) != 0 || version != _version || width <= 0 || height <= 0 || tileSize <= 0)
+                return false;
+
+            std::vector<std::string> channels(channelCount);
+            for (std::string& name : channels) {
+                uint32_t length = 0;
+                readValue(length);
+                name.resize(length);
+                _file.read(name.data(), length);
+            }
+            if (!_file)
+                return false;
+
+            setLayout(width, height, tileSize, channels);
+            _dataOffset = uint64_t(_file.tellg());
+            _written.assign(size_t(_tilesX) * _tilesY, true);
+            return true;
+        }
+
+        bool writeTile(const RenderTile& tile, const std::vector<float>& pixels) {
+            if (pixels.size() < size_t(tile.width()) * tile.height() * _channels.size())
+                return false;
+
+            _file.seekp(tileOffset(tile));
+            _file.write(reinterpret_cast<const char*>(pixels.data()), size_t(tile.width()) * tile.height() * _channels.size() * sizeof(float));
+            _written[tileIndex(tile)] = true;
+            return _file.good();
+        }
+
+        bool readTile(const RenderTile& tile, std::vector<float>& pixels) {
+            pixels.resize(size_t(tile.width()) * tile.height() * _channels.size());
+            _file.seekg(tileOffset(tile));
+            _file.read(reinterpret_cast<char*>(pixels.data()), pixels.size() * sizeof(float));
+            return _file.good();
+        }
+
+        bool complete() const {
+            return std::find(_written.begin(), _written.end(), false) == _written.end();
+        }
+
+        void close() { _file.close(); }
+
+        RenderTile tile(int tx, int ty) const {
+            int x0 = tx * _tileSize;
+            int y0 = ty * _tileSize;
+            return {x0, y0, std::min(x0 + _tileSize, _width), std::min(y0 + _tileSize, _height)};
+        }
+
+        int width() const { return _width; }
+        int height() const { return _height; }
+        int tileSize() const { return _tileSize; }
+        int tilesX() const { return _tilesX; }
+        int tilesY() const { return _tilesY; }
+        const std::vector<std::string>& channels() const { return _channels; }
+    private:
+        static constexpr char _magic[8] = {'R', 'A', 'D', 'T', 'I', 'L', 'E', '\0'};
+        static constexpr uint32_t _version = 1;
+
+        std::fstream _file;
+        int _width = 0;
+        int _height = 0;
+        int _tileSize = 0;
+        int _tilesX = 0;
+        int _tilesY = 0;
+        std::vector<std::string> _channels;
+        std::vector<bool> _written;
+        uint64_t _dataOffset = 0;
+
+        void setLayout(int width, int height, int tileSize, const std::vector<std::string>& channels) {
+            _width = width;
+            _height = height;
+            _tileSize = tileSize;
+            _tilesX = (width + tileSize - 1) / tileSize;
+            _tilesY = (height + tileSize - 1) / tileSize;
+            _channels = channels;
+        }
+
+        size_t tileIndex(const RenderTile& tile) const {
+            return size_t(tile.y0 / _tileSize) * _tilesX + tile.x0 / _tileSize;
+        }
+
+        std::streamoff tileOffset(const RenderTile& tile) const {
+            uint64_t slot = uint64_t(_tileSize) * _tileSize * _channels.size() * sizeof(float);
+            return std::streamoff(_dataOffset + tileIndex(tile) * slot);
+        }
+
+        template<typename T>
+        void writeValue(const T& value) {
+            _file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+        }
+
+        template<typename T>
+        void readValue(T& value) {
+            _file.read(reinterpret_cast<char*>(&value), sizeof(T));
+        }
+};
+
+#endif
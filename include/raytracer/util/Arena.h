@@ -0,0 +1,117 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <new>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+
+class Arena {
+    public:
+        explicit Arena(size_t blockSize = 64 * 1024) : _blockSize(blockSize) {}
+        ~Arena() { release(); }
+
+        Arena(const Arena&) = delete;
+        Arena& operator=(const Arena&) = delete;
+
+        Arena(Arena&& other) noexcept : _blocks(std::move(other._blocks)), _blockSize(other._blockSize), _offset(other._offset), _used(other._used) {
+            other._blocks.clear();
+            other._offset = 0;
+            other._used = 0;
+        }
+
+        void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+            size_t offset = (_offset + alignment - 1) & ~(alignment - 1);
+            if (_blocks.empty() || offset + bytes > _blocks.back().size) {
+                addBlock(std::max(bytes + alignment, _blockSize));
+                offset = 0;
+            }
+
+            _offset = offset + bytes;
+            _used += bytes;
+            return _blocks.back().data + offset;
+        }
+
+        void reset() {
+            if (_blocks.size() > 1) {
+                size_t total = capacity();
+                release();
+                addBlock(total);
+            }
+            _offset = 0;
+            _used = 0;
+        }
+
+        void release() {
+            for (const Block& block : _blocks)
+                ::operator delete(block.data);
+            _blocks.clear();
+            _offset = 0;
+            _used = 0;
+        }
+
+        size_t capacity() const {
+            size_t total = 0;
+            for (const Block& block : _blocks)
+                total += block.size;
+            return total;
+        }
+
+        size_t used() const { return _used; }
+        size_t blockCount() const { return _blocks.size(); }
+
+        static Arena& scratch() {
+            static thread_local Arena arena;
+            return arena;
+        }
+    private:
+        struct Block {
+            char* data;
+            size_t size;
+        };
+
+        std::vector<Block> _blocks;
+        size_t _blockSize;
+        size_t _offset = 0;
+        size_t _used = 0;
+
+        void addBlock(size_t size) {
+            _blocks.push_back({static_cast<char*>(::operator new(size)), size});
+        }
+};
+
+template<typename T>
+class ArenaAllocator {
+    public:
+        using value_type = T;
+        using propagate_on_container_copy_assignment = std::true_type;
+        using propagate_on_container_move_assignment = std::true_type;
+        using propagate_on_container_swap = std::true_type;
+
+        ArenaAllocator(Arena* arena = nullptr) : _arena(arena) {}
+        template<typename U>
+        ArenaAllocator(const ArenaAllocator<U>& other) : _arena(other.arena()) {}
+
+        T* allocate(size_t count) {
+            if (_arena)
+                return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T)));
+            return static_cast<T*>(::operator new(count * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, size_t) {
+            if (!_arena)
+                ::operator delete(pointer);
+        }
+
+        Arena* arena() const { return _arena; }
+
+        template<typename U>
+        bool operator==(const ArenaAllocator<U>& other) const { return _arena == other.arena(); }
+        template<typename U>
+        bool operator!=(const ArenaAllocator<U>& other) const { return _arena != other.arena(); }
+    private:
+        Arena* _arena;
+};
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef BYTESTREAM_H
+#define BYTESTREAM_H
+
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+class ByteWriter {
+    public:
+        template<typename T>
+        void write(const T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "ByteWriter::write needs a trivially copyable type");
+            writeBytes(&value, sizeof(T));
+        }
+
+        template<typename T>
+        void writeVector(const std::vector<T>& values) {
+            write((uint64_t)values.size());
+            writeBytes(values.data(), values.size() * sizeof(T));
+        }
+
+        void writeBytes(const void* data, size_t size) {
+            if (size == 0)
+                return;
+            const char* bytes = static_cast<const char*>(data);
+            _data.insert(_data.end(), bytes, bytes + size);
+        }
+
+        void clear() { _data.clear(); }
+        const std::vector<char>& data() const { return _data; }
+    private:
+        std::vector<char> _data;
+};
+
+class ByteReader {
+    public:
+        ByteReader(const char* data, size_t size) : _data(data), _end(data + size) {}
+        explicit ByteReader(const std::vector<char>& data) : ByteReader(data.data(), data.size()) {}
+
+        template<typename T>
+        bool read(T& value) {
+            static_assert(std::is_trivially_copyable<T>::value, "ByteReader::read needs a trivially copyable type");
+            return readBytes(&value, sizeof(T));
+        }
+
+        template<typename T>
+        bool readVector(std::vector<T>& values) {
+            uint64_t count = 0;
+            if (!read(count) || count > remaining() / sizeof(T))
+                return false;
+            values.resize(count);
+            return readBytes(values.data(), count * sizeof(T));
+        }
+
+        bool readBytes(void* data, size_t size) {
+            if (size > remaining())
+                return false;
+            if (size > 0)
+                std::memcpy(data, _data, size);
+            _data += size;
+            return true;
+        }
+
+        size_t remaining() const { return size_t(_end - _data); }
+    private:
+        const char* _data;
+        const char* _end;
+};
+
+#endif
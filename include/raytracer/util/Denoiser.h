@@ -0,0 +1,278 @@
+#ifndef DENOISER_H
+#define DENOISER_H
+
+#include "RenderBuffers.h"
+#include "Simd.h"
+#include "Arena.h"
+#include <thread>
+#include <atomic>
+
+class Denoiser {
+    public:
+        class Job;
+
+        void denoiseTile(RenderBuffers& buffers, const RenderTile& tile) const {
+            int apron = kernelRadius(_previewIterations);
+            const RenderTile& window = buffers.window();
+            RenderTile region = {
+                std::max(tile.x0 - apron, window.x0), std::max(tile.y0 - apron, window.y0),
+                std::min(tile.x1 + apron, window.x1), std::min(tile.y1 + apron, window.y1)
+            };
+
+            Arena& arena = Arena::scratch();
+            arena.reset();
+
+            Planes planes(&arena);
+            planes.load(buffers, region, true);
+            filter(planes, _previewIterations, 1);
+            planes.store(buffers, region, tile);
+        }
+
+        void denoise(RenderBuffers& buffers, int numThreads) const {
+            denoise(buffers, numThreads, buffers.window());
+        }
+
+        void denoise(RenderBuffers& buffers, int numThreads, const RenderTile& target) const {
+            int apron = kernelRadius(_iterations);
+            RenderTile region = RenderTile{target.x0 - apron, target.y0 - apron, target.x1 + apron, target.y1 + apron}.intersect(buffers.window());
+
+            Planes planes;
+            planes.load(buffers, region, false);
+            filter(planes, _iterations, numThreads);
+            planes.store(buffers, region, target);
+        }
+
+        int apron() const { return kernelRadius(_iterations); }
+        int& iterations() { return _iterations; }
+        int& previewIterations() { return _previewIterations; }
+        float& sigmaColor() { return _sigmaColor; }
+        float& sigmaDepth() { return _sigmaDepth; }
+        float& sigmaAlbedo() { return _sigmaAlbedo; }
+    private:
+        int _iterations = 5;
+        int _previewIterations = 3;
+        float _sigmaColor = 4.0f;
+        float _sigmaDepth = 0.05f;
+        float _sigmaAlbedo = 0.1f;
+
+        static constexpr float _kernel[5] = {1.0f / 16.0f, 1.0f / 4.0f, 3.0f / 8.0f, 1.0f / 4.0f, 1.0f / 16.0f};
+
+        using Plane = std::vector<float, ArenaAllocator<float>>;
+
+        struct Signal {
+            Plane r, g, b, var;
+
+            explicit Signal(Arena* arena = nullptr) : r(arena), g(arena), b(arena), var(arena) {}
+
+            void resize(size_t count) {
+                r.resize(count); g.resize(count); b.resize(count); var.resize(count);
+            }
+        };
+
+        struct Planes {
+            int width = 0, height = 0;
+            Signal signal;
+            Plane ar, ag, ab;
+            Plane nx, ny, nz;
+            Plane z, valid;
+
+            explicit Planes(Arena* arena = nullptr)
+                : signal(arena), ar(arena), ag(arena), ab(arena), nx(arena), ny(arena), nz(arena), z(arena), valid(arena) {}
+
+            void load(const RenderBuffers& buffers, const RenderTile& region, bool checkFinished) {
+                width = region.width();
+                height = region.height();
+                size_t count = size_t(width) * height;
+                signal.resize(count);
+                ar.resize(count); ag.resize(count); ab.resize(count);
+                nx.resize(count); ny.resize(count); nz.resize(count);
+                z.resize(count); valid.resize(count);
+
+                for (int y = 0; y < height; y++) {
+                    for (int x = 0; x < width; x++) {
+                        int i = y * width + x;
+                        int src = buffers.index(region.x0 + x, region.y0 + y);
+                        bool finished = !checkFinished || buffers.isPixelFinished(region.x0 + x, region.y0 + y);
+
+                        const Color& c = finished ? buffers.color[src] : Color(0.0f);
+                        const Color& a = finished ? buffers.albedo[src] : Color(0.0f);
+                        const glm::vec3& n = finished ? buffers.normal[src] : glm::vec3(0.0f);
+
+                        signal.r[i] = c.r; signal.g[i] = c.g; signal.b[i] = c.b;
+                        signal.var[i] = finished ? buffers.variance[src] : 0.0f;
+                        ar[i] = a.r; ag[i] = a.g; ab[i] = a.b;
+                        nx[i] = n.x; ny[i] = n.y; nz[i] = n.z;
+                        z[i] = finished ? buffers.depth[src] : 0.0f;
+                        valid[i] = finished ? 1.0f : 0.0f;
+                    }
+                }
+            }
+
+            void store(RenderBuffers& buffers, const RenderTile& region, const RenderTile& target) const {
+                for (int y = target.y0; y < target.y1; y++) {
+                    for (int x = target.x0; x < target.x1; x++) {
+                        int i = (y - region.y0) * width + (x - region.x0);
+                        buffers.denoised[buffers.index(x, y)] = Color(signal.r[i], signal.g[i], signal.b[i]);
+                    }
+                }
+            }
+        };
+
+        static int kernelRadius(int iterations) {
+            return 2 * ((1 << iterations) - 1);
+        }
+
+        static void load(const float* p, float& out) { out = *p; }
+        static void load(const float* p, Float4& out) { out = Float4::load(p); }
+        static void store(float* p, float value) { *p = value; }
+        static void store(float* p, const Float4& value) { value.store(p); }
+
+        void filter(Planes& planes, int iterations, int numThreads) const {
+            Signal scratch(planes.signal.r.get_allocator().arena());
+            scratch.resize(planes.signal.r.size());
+
+            for (int i = 0; i < iterations; i++) {
+                int step = 1 << i;
+                std::atomic<int> nextRow(0);
+
+                auto worker = [&]() {
+                    int y;
+                    while ((y = nextRow.fetch_add(1)) < planes.height)
+                        filterRow(planes, planes.signal, scratch, y, step);
+                };
+
+                if (numThreads <= 1) {
+                    worker();
+                } else {
+                    std::vector<std::thread> threads;
+                    for (int t = 0; t < numThreads; t++)
+                        threads.emplace_back(worker);
+                    for (auto& t : threads)
+                        t.join();
+                }
+
+                std::swap(planes.signal, scratch);
+            }
+        }
+
+        void filterRow(const Planes& planes, const Signal& src, Signal& dst, int y, int step) const {
+            int width = planes.width;
+            int simdBegin = 2 * step;
+            int simdEnd = width - 2 * step - Float4::width;
+
+            int x = 0;
+            for (; x < std::min(simdBegin, width); x++)
+                filterSpan<float>(planes, src, dst, x, y, step);
+            for (; x <= simdEnd; x += Float4::width)
+                filterSpan<Float4>(planes, src, dst, x, y, step);
+            for (; x < width; x++)
+                filterSpan<float>(planes, src, dst, x, y, step);
+        }
+
+        template<typename T>
+        void filterSpan(const Planes& p, const Signal& src, Signal& dst, int x, int y, int step) const {
+            using std::min; using std::max; using std::sqrt; using std::abs;
+            constexpr int lanes = sizeof(T) / sizeof(float);
+
+            int c = y * p.width + x;
+            T cr, cg, cb, cvar, car, cag, cab, cnx, cny, cnz, cz;
+            load(&src.r[c], cr); load(&src.g[c], cg); load(&src.b[c], cb); load(&src.var[c], cvar);
+            load(&p.ar[c], car); load(&p.ag[c], cag); load(&p.ab[c], cab);
+            load(&p.nx[c], cnx); load(&p.ny[c], cny); load(&p.nz[c], cnz);
+            load(&p.z[c], cz);
+
+            T lumC = T(0.2126f) * cr + T(0.7152f) * cg + T(0.0722f) * cb;
+            T invSigmaL = T(1.0f) / (T(_sigmaColor) * sqrt(max(cvar, T(0.0f))) + T(1e-4f));
+            T invSigmaZ = T(1.0f) / (T(_sigmaDepth * float(step)) * cz + T(1e-4f));
+            T invSigmaA = T(1.0f / (_sigmaAlbedo * _sigmaAlbedo));
+
+            T center = T(_kernel[2] * _kernel[2]);
+            T sumR = center * cr, sumG = center * cg, sumB = center * cb;
+            T sumVar = center * center * cvar;
+            T sumW = center;
+
+            for (int dy = -2; dy <= 2; dy++) {
+                int yy = y + dy * step;
+                if (yy < 0 || yy >= p.height) continue;
+
+                for (int dx = -2; dx <= 2; dx++) {
+                    if (dx == 0 && dy == 0) continue;
+                    int xx = x + dx * step;
+                    if (xx < 0 || xx + lanes - 1 >= p.width) continue;
+
+                    int q = yy * p.width + xx;
+                    T qr, qg, qb, qvar, qar, qag, qab, qnx, qny, qnz, qz, qvalid;
+                    load(&src.r[q], qr); load(&src.g[q], qg); load(&src.b[q], qb); load(&src.var[q], qvar);
+                    load(&p.ar[q], qar); load(&p.ag[q], qag); load(&p.ab[q], qab);
+                    load(&p.nx[q], qnx); load(&p.ny[q], qny); load(&p.nz[q], qnz);
+                    load(&p.z[q], qz); load(&p.valid[q], qvalid);
+
+                    T lumQ = T(0.2126f) * qr + T(0.7152f) * qg + T(0.0722f) * qb;
+
+                    T normalWeight = max(cnx * qnx + cny * qny + cnz * qnz, T(0.0f));
+                    for (int k = 0; k < 7; k++)
+                        normalWeight = normalWeight * normalWeight;
+
+                    T dar = car - qar, dag = cag - qag, dab = cab - qab;
+                    T exponent = abs(lumC - lumQ) * invSigmaL
+                               + abs(cz - qz) * invSigmaZ
+                               + (dar * dar + dag * dag + dab * dab) * invSigmaA;
+
+                    T weight = T(_kernel[dx + 2] * _kernel[dy + 2]) * normalWeight * qvalid * expNeg(exponent);
+
+                    sumR = sumR + weight * qr;
+                    sumG = sumG + weight * qg;
+                    sumB = sumB + weight * qb;
+                    sumVar = sumVar + weight * weight * qvar;
+                    sumW = sumW + weight;
+                }
+            }
+
+            T invW = T(1.0f) / sumW;
+            store(&dst.r[c], sumR * invW);
+            store(&dst.g[c], sumG * invW);
+            store(&dst.b[c], sumB * invW);
+            store(&dst.var[c], sumVar * invW * invW);
+        }
+};
+
+class Denoiser::Job {
+    public:
+        void begin(const Denoiser& denoiser, RenderBuffers& buffers, const RenderTile& target) {
+            int apron = kernelRadius(denoiser._iterations);
+            _denoiser = &denoiser;
+            _buffers = &buffers;
+            _target = target;
+            _region = RenderTile{target.x0 - apron, target.y0 - apron, target.x1 + apron, target.y1 + apron}.intersect(buffers.window());
+            _planes.load(buffers, _region, false);
+            _scratch.resize(_planes.signal.r.size());
+        }
+
+        int iterations() const { return _denoiser->_iterations; }
+        int bands() const { return (_planes.height + bandHeight - 1) / bandHeight; }
+
+        void filter(int iteration, int band) {
+            int end = std::min((band + 1) * bandHeight, _planes.height);
+            for (int y = band * bandHeight; y < end; y++)
+                _denoiser->filterRow(_planes, _planes.signal, _scratch, y, 1 << iteration);
+        }
+
+        void swap() {
+            std::swap(_planes.signal, _scratch);
+        }
+
+        void store() {
+            _planes.store(*_buffers, _region, _target);
+        }
+    private:
+        static constexpr int bandHeight = 16;
+
+        const Denoiser* _denoiser = nullptr;
+        RenderBuffers* _buffers = nullptr;
+        RenderTile _target = {0, 0, 0, 0};
+        RenderTile _region = {0, 0, 0, 0};
+        Planes _planes;
+        Signal _scratch;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef FIRSTTOUCHALLOCATOR_H
+#define FIRSTTOUCHALLOCATOR_H
+
+#include <new>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+    #include <sys/mman.h>
+#endif
+
+template<typename T>
+class FirstTouchAllocator {
+    public:
+        using value_type = T;
+
+        FirstTouchAllocator() = default;
+        template<typename U>
+        FirstTouchAllocator(const FirstTouchAllocator<U>&) {}
+
+        T* allocate(size_t count) {
+            size_t bytes = count * sizeof(T);
+#ifndef _WIN32
+            if (bytes >= _mapThreshold) {
+                void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+                if (memory == MAP_FAILED)
+                    throw std::bad_alloc();
+                return static_cast<T*>(memory);
+            }
+#endif
+            return static_cast<T*>(::operator new(bytes));
+        }
+
+        void deallocate(T* pointer, size_t count) {
+#ifndef _WIN32
+            if (count * sizeof(T) >= _mapThreshold) {
+                munmap(pointer, count * sizeof(T));
+                return;
+            }
+#endif
+            ::operator delete(pointer);
+        }
+
+        template<typename U>
+        void construct(U* pointer) {
+            ::new(static_cast<void*>(pointer)) U;
+        }
+
+        template<typename U, typename... Args>
+        void construct(U* pointer, Args&&... args) {
+            ::new(static_cast<void*>(pointer)) U(std::forward<Args>(args)...);
+        }
+
+        template<typename U>
+        bool operator==(const FirstTouchAllocator<U>&) const { return true; }
+        template<typename U>
+        bool operator!=(const FirstTouchAllocator<U>&) const { return false; }
+    private:
+        static constexpr size_t _mapThreshold = size_t(1) << 20;
+};
+
+template<typename T>
+using BufferVector = std::vector<T, FirstTouchAllocator<T>>;
+
+#endif
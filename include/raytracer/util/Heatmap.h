@@ -0,0 +1,65 @@
+#ifndef HEATMAP_H
+#define HEATMAP_H
+
+#include "RaytracerUtils.h"
+#include <cmath>
+#include <algorithm>
+
+enum class DisplayMode {
+    Beauty,
+    Time,
+    BVHNodes,
+    SDFSteps,
+    Samples,
+    END
+};
+
+inline constexpr const char* displayModeNames[] = {
+    "Beauty",
+    "Time per pixel",
+    "BVH nodes",
+    "SDF steps",
+    "Samples"
+};
+
+class Heatmap {
+    public:
+        template<typename T>
+        static float maxValue(const T* values, size_t count) {
+            float result = 0.0f;
+            for (size_t i = 0; i < count; i++)
+                result = std::max(result, float(values[i]));
+            return result;
+        }
+
+        template<typename T>
+        static void apply(const T* values, size_t count, float maxValue, unsigned char* dst) {
+            float invLogMax = maxValue > 0.0f ? 1.0f / std::log1p(maxValue) : 0.0f;
+
+            for (size_t i = 0; i < count; i++) {
+                Color c = color(std::log1p(std::max(float(values[i]), 0.0f)) * invLogMax);
+                dst[i * 3 + 0] = static_cast<unsigned char>(c.r * 255.0f + 0.5f);
+                dst[i * 3 + 1] = static_cast<unsigned char>(c.g * 255.0f + 0.5f);
+                dst[i * 3 + 2] = static_cast<unsigned char>(c.b * 255.0f + 0.5f);
+            }
+        }
+
+        static Color color(float t) {
+            static const Color stops[] = {
+                Color(0.0f, 0.0f, 0.0f),
+                Color(0.1f, 0.1f, 0.8f),
+                Color(0.0f, 0.8f, 0.8f),
+                Color(0.2f, 0.9f, 0.1f),
+                Color(1.0f, 0.9f, 0.0f),
+                Color(1.0f, 0.1f, 0.0f),
+                Color(1.0f, 1.0f, 1.0f)
+            };
+            const int last = int(sizeof(stops) / sizeof(stops[0])) - 1;
+
+            float x = std::clamp(t, 0.0f, 1.0f) * float(last);
+            int i = std::min(int(x), last - 1);
+            return glm::mix(stops[i], stops[i + 1], x - float(i));
+        }
+};
+
+#endif
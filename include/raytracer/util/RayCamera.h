@@ -5,60 +5,121 @@
 #include "RayMaterial.h"
 #include "../light/RayLight.h"
 #include "../light/RayLightList.h"
+#include "../light/LightSampler.h"
+#include "RenderBuffers.h"
+#include "Denoiser.h"
+#include "Tonemapper.h"
+#include "RenderStats.h"
+#include "Heatmap.h"
+#include "../output/Checkpoint.h"
+#include "RenderQueue.h"
+#include "Wavefront.h"
+#include <chrono>
+#include <functional>
+#include <thread>
+#include <atomic>
+
+struct SceneView {
+    const Hittable* world;
+    const RayLightList* lights;
+};
 
 class RayCamera {
     public:
-        std::function<void(int j)> onScanlineFinished;
-        unsigned char* imageDataBuffer;
+        std::function<void(const RenderTile& tile)> onTileFinished;
+        unsigned char* imageDataBuffer = nullptr;
 
         void render(const Hittable& world, const RayLightList& lights) {
+            submit(RenderQueue::shared(), world, lights)->wait();
+        }
+
+        RenderJobHandle submit(RenderQueue& queue, const Hittable& world, const RayLightList& lights, int priority = 0, std::function<void()> setup = nullptr) {
+            return submit(queue, std::vector<SceneView>{{&world, &lights}}, priority, std::move(setup));
+        }
+
+        RenderJobHandle submit(RenderQueue& queue, std::vector<SceneView> replicas, int priority = 0, std::function<void()> setup = nullptr) {
+            return queue.submit(std::make_shared<Task>(*this, std::move(replicas), std::move(setup)), priority);
+        }
+
+        void prepare() {
             initialize();
+        }
 
-            int numThreads = std::thread::hardware_concurrency();
-            std::vector<std::thread> threads;
-            std::atomic<int> nextRow(_imageHeight - 1);
+        void beginRender() {
+            _finishedTiles.store(0);
+            _tileCount.store((int)_jobs.size());
+            _stats.reset();
+        }
 
-            RayCamera::scanlineSize.store(_imageHeight);
-            auto worker = [&]() {
-                int j;
-                while ((j = nextRow.fetch_sub(1)) >= 0) {
-                    RayCamera::currentScanline.store(j);
-                    for (int i = 0; i < _imageWidth; i++) {
-                        Color mean(0.0f);
-                        Color M2(0.0f);
-                        int samplesTaken = 0;
-                        for (int sample = 0; sample < _samplesPerPixel; sample++) {
-                            Ray ray = getRay(i, j);
-                            Color newSample = rayColor(ray, _maxDepth, world, lights);
-                            samplesTaken++;
-
-                            Color delta = newSample - mean;
-                            mean += delta / float(samplesTaken);
-                            Color delta2 = newSample - mean;
-                            M2 += delta * delta2;
-
-                            if (sample >= _minSamplesPerPixel - 1) {
-                                Color variance = M2 / float(samplesTaken - 1);
-                                float avgVariance = (variance.x + variance.y + variance.z) / 3.0f;
-
-                                if (avgVariance < _varianceThreshold)
-                                    break;
-                            }
-                        }
+        void renderJob(int tileIndex, const Hittable& world, const RayLightList& lights) {
+            const RenderTile& tile = _jobs[tileIndex];
+            seedRandom(mixSeed(mixSeed(_samplerSeed, _samplerPass), uint64_t(tileIndex)));
+            if (hasRegion() || _clearTiles) {
+                _buffers.markTileUnfinished(tile);
+                _buffers.clearTile(tile);
+            }
+            renderTile(tile, world, lights);
+        }
+
+        void finishTile(const RenderTile& tile) {
+            _buffers.markTileFinished(tile);
 
-                        Color pixelColor = mean;
+            if (_denoise)
+                _denoiser.denoiseTile(_buffers, tile);
+            writeDisplay(tile);
 
-                        pixelColor.x = linearToGamma(pixelColor.x);
-                        pixelColor.y = linearToGamma(pixelColor.y);
-                        pixelColor.z = linearToGamma(pixelColor.z);
+            _finishedTiles++;
+            if (onTileFinished) onTileFinished(tile);
+        }
+
+        void endRender(int numThreads) {
+            if (_denoise) {
+                _denoiser.denoise(_buffers, numThreads, denoiseTarget());
+                showDenoised();
+            }
+
+            _stats.finish();
+        }
 
-                        int index = (j * _imageWidth + i) * 3;
-                        static const Interval intensity(0.0f, 0.999f);
-                        imageDataBuffer[index]     = static_cast<unsigned char>(256 * intensity.clamp(pixelColor.x));
-                        imageDataBuffer[index + 1] = static_cast<unsigned char>(256 * intensity.clamp(pixelColor.y));
-                        imageDataBuffer[index + 2] = static_cast<unsigned char>(256 * intensity.clamp(pixelColor.z));
+        void cancelRender() {
+            _stats.finish();
+        }
+
+        void addStats(const RenderCounters& counters) {
+            _stats.add(counters);
+        }
+
+        bool writeCheckpoint() {
+            return Checkpoint::write(_checkpointPath, checkpointHeader(), _buffers);
+        }
+
+        void beginProgressive() {
+            initialize();
+            _progressiveStride = _coarsestStride;
+            _progressiveSkip = 0;
+            _progressiveSamples = 0;
+            _stats.reset();
+        }
+
+        bool renderPass(const Hittable& world, const RayLightList& lights, const std::atomic<bool>& cancel) {
+            int numThreads = std::thread::hardware_concurrency();
+            std::vector<std::thread> threads;
+            const std::vector<RenderTile>& tiles = _buffers.tiles();
+            std::atomic<int> nextTile(0);
+            bool displayTiles = !_denoise && _progressiveStride == 1 && _progressiveSkip == 0;
+
+            auto worker = [&]() {
+                int t;
+                while (!cancel.load(std::memory_order_relaxed) && (t = nextTile.fetch_add(1)) < (int)tiles.size()) {
+                    const RenderTile& tile = tiles[t];
+                    accumulateTile(tile, world, lights);
+                    _stats.flush();
+                    _buffers.markTileFinished(tile);
+
+                    if (displayTiles) {
+                        writeDisplay(tile);
+                        if (onTileFinished) onTileFinished(tile);
                     }
-                    if (onScanlineFinished) onScanlineFinished(j);
                 }
             };
 
@@ -66,7 +127,41 @@ class RayCamera {
                 threads.emplace_back(worker);
             for (auto& t : threads)
                 t.join();
-            denoise();
+
+            if (cancel.load())
+                return false;
+
+            RenderTile frame = _buffers.window();
+            if (_progressiveStride > 1) {
+                upsample(_progressiveStride);
+                writeDisplay(frame, _upsampled);
+                if (onTileFinished) onTileFinished(frame);
+
+                _progressiveSkip = _progressiveStride;
+                _progressiveStride /= 2;
+                return true;
+            }
+
+            if (_denoise) {
+                _denoiser.denoise(_buffers, numThreads);
+                updateDisplay();
+                if (onTileFinished) onTileFinished(frame);
+            } else if (_progressiveSkip > 0) {
+                updateDisplay();
+                if (onTileFinished) onTileFinished(frame);
+            }
+
+            _progressiveSkip = 0;
+            _progressiveSamples++;
+            return true;
+        }
+
+        void updateDisplay() {
+            writeDisplay(_buffers.window());
+        }
+
+        int frameHeight() const {
+            return std::max(int(_imageWidth / _aspectRatio), 1);
         }
 
         float& aspectRatio() { return _aspectRatio; }
@@ -76,10 +171,120 @@ class RayCamera {
         int& maxDepth() { return _maxDepth; }
         Color& skyboxColor() { return _skyboxColor; }
         Transform& transform() { return _transform; }
-
-        inline static std::atomic<int> currentScanline = -1;
-        inline static std::atomic<int> scanlineSize = -1;
+        bool& denoise() { return _denoise; }
+        Integrator& integrator() { return _integrator; }
+        bool& sortRays() { return _wavefront.sortRays; }
+        bool& cacheOccluders() { return _wavefront.cacheOccluders; }
+        LightSelection& lightSelection() { return _lightSelection; }
+        int& lightSamples() { return _lightSamples; }
+        AOVSettings& aovs() { return _aovs; }
+        Denoiser& denoiser() { return _denoiser; }
+        Tonemapper& tonemapper() { return _tonemapper; }
+        DisplayMode& displayMode() { return _displayMode; }
+        const RenderBuffers& buffers() const { return _buffers; }
+        RenderBuffers& buffers() { return _buffers; }
+        int progressiveSamples() const { return _progressiveSamples; }
+        RenderCounters stats() const { return _stats.snapshot(); }
+        int& coarsestStride() { return _coarsestStride; }
+        std::string& checkpointPath() { return _checkpointPath; }
+        float& checkpointInterval() { return _checkpointInterval; }
+        bool& resume() { return _resume; }
+        bool resumed() const { return _resumed; }
+        bool resumeFailed() const { return _resumeFailed; }
+        uint64_t& sceneHash() { return _sceneHash; }
+        uint64_t& samplerSeed() { return _samplerSeed; }
+        uint32_t& samplerPass() { return _samplerPass; }
+        RenderTile& window() { return _window; }
+        RenderTile& region() { return _region; }
+        bool hasRegion() const { return !_region.empty(); }
+        const std::vector<RenderTile>& jobs() const { return _jobs; }
+        int tileSize() const { return _tileSize; }
+        bool& firstTouch() { return _firstTouch; }
+        int finishedTiles() const { return _finishedTiles.load(); }
+        int tileCount() const { return _tileCount.load(); }
     private:
+        class Task : public RenderTask {
+            public:
+                Task(RayCamera& camera, std::vector<SceneView> replicas, std::function<void()> setup)
+                    : _camera(camera), _replicas(std::move(replicas)), _setup(std::move(setup)) {}
+
+                int begin() override {
+                    if (_setup) _setup();
+                    if (!_camera.start())
+                        return -1;
+                    _lastCheckpoint = std::chrono::steady_clock::now();
+                    return (int)_camera._jobs.size();
+                }
+
+                int passes() override {
+                    return _camera._denoise ? _camera._denoiser.iterations() : 0;
+                }
+
+                int beginPass(int pass) override {
+                    if (pass == 0)
+                        _denoise.begin(_camera._denoiser, _camera._buffers, _camera.denoiseTarget());
+                    else
+                        _denoise.swap();
+                    _passes = pass + 1;
+                    return _denoise.bands();
+                }
+
+                void renderPass(int pass, int index) override {
+                    _denoise.filter(pass, index);
+                }
+
+                void renderTile(int index) override {
+                    const SceneView& scene = _replicas[std::min(RenderQueue::workerNode(), (int)_replicas.size() - 1)];
+                    _camera.renderJob(index, *scene.world, *scene.lights);
+                    _camera._stats.flush();
+                    _camera.finishTile(_camera._jobs[index]);
+                }
+
+                bool wantsPause() override {
+                    auto interval = std::chrono::duration<float>(_camera._checkpointInterval);
+                    return _camera.checkpointing() && std::chrono::steady_clock::now() - _lastCheckpoint >= interval;
+                }
+
+                void pause() override {
+                    _camera.writeCheckpoint();
+                    _lastCheckpoint = std::chrono::steady_clock::now();
+                }
+
+                void end(bool cancelled) override {
+                    if (_camera._resumeFailed) {
+                        _camera._stats.finish();
+                        return;
+                    }
+
+                    if (_camera.checkpointing())
+                        _camera.writeCheckpoint();
+
+                    if (cancelled && _camera._clearTiles) {
+                        for (const RenderTile& tile : _camera._jobs) {
+                            if (!_camera._buffers.isPixelFinished(tile.x0, tile.y0))
+                                _camera._buffers.clearTile(tile);
+                        }
+                    }
+
+                    if (!cancelled && _camera._denoise) {
+                        if (_passes == 0)
+                            _denoise.begin(_camera._denoiser, _camera._buffers, _camera.denoiseTarget());
+                        else
+                            _denoise.swap();
+                        _denoise.store();
+                        _camera.showDenoised();
+                    }
+                    _camera._stats.finish();
+                }
+            private:
+                RayCamera& _camera;
+                std::vector<SceneView> _replicas;
+                std::function<void()> _setup;
+                std::chrono::steady_clock::time_point _lastCheckpoint;
+                Denoiser::Job _denoise;
+                int _passes = 0;
+        };
+
         float _aspectRatio = 1.0f;
         int _imageWidth = 100;
         int _samplesPerPixel = 10;
@@ -87,6 +292,20 @@ class RayCamera {
         Color _skyboxColor = Color(0.0f);
         int _minSamplesPerPixel = 10;
         float _varianceThreshold = 0.0005f;
+        int _tileSize = 32;
+        bool _denoise = true;
+        Integrator _integrator = Integrator::Megakernel;
+        WavefrontOptions _wavefront;
+        LightSelection _lightSelection = LightSelection::All;
+        int _lightSamples = 1;
+        AOVSettings _aovs;
+        RenderTile _window = {0, 0, 0, 0};
+        RenderTile _region = {0, 0, 0, 0};
+        std::vector<RenderTile> _jobs;
+        std::atomic<int> _finishedTiles = 0;
+        std::atomic<int> _tileCount = 0;
+        bool _firstTouch = true;
+        bool _clearTiles = false;
 
         float fov = 90.0f;
         int _imageHeight;
@@ -95,7 +314,26 @@ class RayCamera {
         glm::vec3 _pixel00Loc;
         glm::vec3 _pixelDeltaU;
         glm::vec3 _pixelDeltaV;
-        std::vector<unsigned char> _imageData;
+        RenderBuffers _buffers;
+        Denoiser _denoiser;
+        Tonemapper _tonemapper;
+        RenderStats _stats;
+        DisplayMode _displayMode = DisplayMode::Beauty;
+        std::atomic<float> _heatmapMax = 0.0f;
+        std::string _checkpointPath;
+        float _checkpointInterval = 0.0f;
+        bool _resume = false;
+        bool _resumed = false;
+        bool _resumeFailed = false;
+        uint64_t _sceneHash = 0;
+        uint64_t _samplerSeed = 0;
+        uint32_t _samplerPass = 0;
+        BufferVector<Color> _upsampled;
+        int _coarsestStride = 4;
+        float _upsampleSigmaDepth = 0.05f;
+        int _progressiveStride = 1;
+        int _progressiveSkip = 0;
+        int _progressiveSamples = 0;
 
         Transform _transform;
         glm::vec3 _forward {0.0f, 0.0f, -1.0f};
@@ -113,11 +351,41 @@ class RayCamera {
             _up = glm::normalize(glm::cross(_right, _forward));
         }
 
-        void initialize() {
-            _imageHeight = int(_imageWidth / _aspectRatio);
-            _imageHeight = (_imageHeight < 1) ? 1 : _imageHeight;
+        bool start() {
+            initialize(_firstTouch && !hasRegion() && !_resume && !checkpointing());
+            _resumed = _resume && !hasRegion() && loadCheckpoint();
+            _resumeFailed = _resume && !hasRegion() && !_resumed;
+            if (_resumeFailed)
+                return false;
+
+            if (_resumed) {
+                _samplerPass++;
+            } else {
+                _samplerSeed = (uint64_t(std::random_device{}()) << 32) | std::random_device{}();
+                _samplerPass = 0;
+            }
+            beginRender();
+            return true;
+        }
+
+        void initialize(bool firstTouch = false) {
+            _imageHeight = frameHeight();
 
-            _imageData.resize(_imageWidth * _imageHeight * 3);
+            RenderTile window = {0, 0, _imageWidth, _imageHeight};
+            if (_window.width() > 0 && _window.height() > 0) {
+                window.x0 = glm::clamp(_window.x0, 0, _imageWidth - 1);
+                window.y0 = glm::clamp(_window.y0, 0, _imageHeight - 1);
+                window.x1 = glm::clamp(_window.x1, window.x0 + 1, _imageWidth);
+                window.y1 = glm::clamp(_window.y1, window.y0 + 1, _imageHeight);
+            }
+
+            bool keepBuffers = hasRegion() && _buffers.width() == _imageWidth && _buffers.height() == _imageHeight
+                && _buffers.window() == window && _buffers.aovs() == _aovs;
+            if (!keepBuffers)
+                _buffers.resize(_imageWidth, _imageHeight, window, _tileSize, _aovs, firstTouch);
+            _clearTiles = firstTouch && !keepBuffers;
+            _jobs = hasRegion() ? _buffers.tilesIn(_region) : _buffers.tiles();
+            _heatmapMax.store(0.0f);
 
             _pixelSamplesScale = 1.0f / float(_samplesPerPixel);
 
@@ -140,6 +408,49 @@ class RayCamera {
             _pixel00Loc = viewportUpperLeft + 0.5f * (_pixelDeltaU + _pixelDeltaV);
         }
 
+        bool checkpointing() const {
+            return !_checkpointPath.empty() && _checkpointInterval > 0.0f && !hasRegion();
+        }
+
+        Checkpoint::Header checkpointHeader() const {
+            uint64_t hash = _sceneHash;
+            hash = mixSeed(hash, uint64_t(_maxDepth));
+            const bool aovs[] = {_aovs.depth, _aovs.normal, _aovs.albedo, _aovs.objectId, _aovs.materialId,
+                                 _aovs.sampleCount, _aovs.direct, _aovs.indirect, _aovs.cost};
+            for (bool aov : aovs)
+                hash = mixSeed(hash, uint64_t(aov));
+            for (int k = 0; k < 3; k++) {
+                hash = mixSeed(hash, std::hash<float>()(_transform.position[k]));
+                hash = mixSeed(hash, std::hash<float>()(_transform.rotation[k]));
+            }
+            return {_imageWidth, _imageHeight, hash, _samplerSeed, _samplerPass};
+        }
+
+        bool loadCheckpoint() {
+            Checkpoint::Header header;
+            Checkpoint::Header expected = checkpointHeader();
+            if (_checkpointPath.empty() || !Checkpoint::readHeader(_checkpointPath, header))
+                return false;
+            if (header.width != expected.width || header.height != expected.height || header.sceneHash != expected.sceneHash)
+                return false;
+
+            if (!Checkpoint::read(_checkpointPath, _buffers)) {
+                _buffers.resize(_imageWidth, _imageHeight, _buffers.window(), _tileSize, _aovs);
+                return false;
+            }
+
+            _samplerSeed = header.samplerSeed;
+            _samplerPass = header.samplerPass;
+            return true;
+        }
+
+        static uint64_t mixSeed(uint64_t seed, uint64_t value) {
+            uint64_t z = seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
         Ray getRay(int i, int j) const {
             glm::vec3 offset = sampleSquare();
             glm::vec3 pixelSample = _pixel00Loc + (float(i) + offset.x) * _pixelDeltaU + (float(_imageHeight - 1 - j) + offset.y) * _pixelDeltaV;
@@ -156,104 +467,432 @@ class RayCamera {
             return glm::vec3(r1 - 0.5f, r2 - 0.5f, 0);
         }
 
-        void denoise() {
-            for (int pass = 0; pass < 2; pass++) {
-                denoisePass();
+        struct PixelAccumulator {
+            int x, y, index;
+            int samplesTaken;
+            Color mean, M2;
+            SampleFeatures features;
+        };
+
+        PixelAccumulator loadPixel(int i, int j) const {
+            int index = _buffers.index(i, j);
+            int samplesTaken = _buffers.sampleCount[index];
+            PixelAccumulator pixel = {i, j, index, samplesTaken, _buffers.color[index], _buffers.m2[index], SampleFeatures()};
+
+            SampleFeatures& features = pixel.features;
+            features.albedo = _buffers.albedo[index] * float(samplesTaken);
+            features.normal = _buffers.normal[index] * float(samplesTaken);
+            features.depth = _buffers.depth[index] * float(samplesTaken);
+            if (_aovs.objectId) features.objectId = _buffers.objectId[index];
+            if (_aovs.materialId) features.materialId = _buffers.materialId[index];
+            if (_aovs.direct) features.direct = _buffers.direct[index] * float(samplesTaken);
+            if (_aovs.indirect) features.indirect = _buffers.indirect[index] * float(samplesTaken);
+
+            RenderStats::count(Counter::Pixels);
+            return pixel;
+        }
+
+        bool wantsSample(const PixelAccumulator& pixel) const {
+            if (pixel.samplesTaken >= _samplesPerPixel)
+                return false;
+            if (pixel.samplesTaken < _minSamplesPerPixel)
+                return true;
+
+            Color variance = pixel.M2 / float(pixel.samplesTaken - 1);
+            float avgVariance = (variance.x + variance.y + variance.z) / 3.0f;
+            return !(avgVariance < _varianceThreshold);
+        }
+
+        Ray cameraRay(int i, int j) const {
+            RenderStats::count(Counter::CameraRays);
+            RenderStats::count(Counter::Paths);
+            RenderStats::count(Counter::Samples);
+            return getRay(i, j);
+        }
+
+        static void addSample(PixelAccumulator& pixel, const Color& sample, const SampleFeatures& sampleFeatures) {
+            pixel.samplesTaken++;
+
+            Color delta = sample - pixel.mean;
+            pixel.mean += delta / float(pixel.samplesTaken);
+            Color delta2 = sample - pixel.mean;
+            pixel.M2 += delta * delta2;
+
+            SampleFeatures& features = pixel.features;
+            features.albedo += sampleFeatures.albedo;
+            features.normal += sampleFeatures.normal;
+            features.depth += sampleFeatures.depth;
+            features.direct += sampleFeatures.direct;
+            features.indirect += sampleFeatures.indirect;
+            if (pixel.samplesTaken == 1) {
+                features.objectId = sampleFeatures.objectId;
+                features.materialId = sampleFeatures.materialId;
             }
         }
 
-        void denoisePass() {
-            int height = _imageHeight;
-            std::vector<unsigned char> output(_imageWidth * height * 3);
+        void storePixel(PixelAccumulator& pixel) {
+            int index = pixel.index;
+            int samplesTaken = pixel.samplesTaken;
+            SampleFeatures& features = pixel.features;
+
+            float invSamples = 1.0f / float(std::max(samplesTaken, 1));
+            _buffers.color[index] = pixel.mean;
+            _buffers.m2[index] = pixel.M2;
+            _buffers.albedo[index] = features.albedo * invSamples;
+            _buffers.normal[index] = isVectorNearZero(features.normal) ? glm::vec3(0.0f) : glm::normalize(features.normal);
+            _buffers.depth[index] = features.depth * invSamples;
+
+            Color variance = samplesTaken > 1 ? pixel.M2 / float(samplesTaken - 1) : Color(0.0f);
+            _buffers.variance[index] = (variance.x + variance.y + variance.z) / 3.0f * invSamples;
+            _buffers.sampleCount[index] = samplesTaken;
+
+            if (_aovs.objectId) _buffers.objectId[index] = features.objectId;
+            if (_aovs.materialId) _buffers.materialId[index] = features.materialId;
+            if (_aovs.direct) _buffers.direct[index] = features.direct * invSamples;
+            if (_aovs.indirect) _buffers.indirect[index] = features.indirect * invSamples;
+        }
 
-            const int radius = 1;
-            const float sigmaSpace = 1.0f;
+        void renderTile(const RenderTile& tile, const Hittable& world, const RayLightList& lights) {
+            if (_integrator == Integrator::Wavefront) {
+                renderTileWavefront(tile, world, lights);
+                return;
+            }
 
-            for (int y = 0; y < height; y++) {
-                for (int x = 0; x < _imageWidth; x++) {
-                    glm::vec3 centerColor = getPixel(x, y);
-                    float brightness = (centerColor.r + centerColor.g + centerColor.b) / 3.0f;
-                    float sigmaColor = glm::mix(0.01f, 0.04f, 1.0f - brightness);
-                    glm::vec3 sum(0.0f);
-                    float weightSum = 0.0f;
+            for (int j = tile.y0; j < tile.y1; j++) {
+                for (int i = tile.x0; i < tile.x1; i++) {
+                    PixelCost cost = beginCost();
+                    PixelAccumulator pixel = loadPixel(i, j);
 
-                    for (int dy = -radius; dy <= radius; dy++) {
-                        for (int dx = -radius; dx <= radius; dx++) {
-                            int nx = glm::clamp(x + dx, 0, _imageWidth - 1);
-                            int ny = glm::clamp(y + dy, 0, height - 1);
+                    while (wantsSample(pixel)) {
+                        SampleFeatures sampleFeatures;
+                        Color sample = rayColor(cameraRay(i, j), _maxDepth, world, lights, &sampleFeatures);
+                        addSample(pixel, sample, sampleFeatures);
+                    }
+
+                    storePixel(pixel);
+                    if (_aovs.cost) endCost(cost, pixel.index);
+                }
+            }
+        }
 
-                            glm::vec3 neighborColor = getPixel(nx, ny);
+        void renderTileWavefront(const RenderTile& tile, const Hittable& world, const RayLightList& lights) {
+            static thread_local std::vector<PixelAccumulator> pixels;
+            WavefrontIntegrator& integrator = WavefrontIntegrator::local();
+            std::vector<PathState>& paths = integrator.paths();
 
-                            float spaceDist = float(dx * dx + dy * dy) / (2.0f * sigmaSpace * sigmaSpace);
-                            glm::vec3 colorDiff = neighborColor - centerColor;
-                            float colorDist = glm::dot(colorDiff, colorDiff) / (2.0f * sigmaColor * sigmaColor);
+            pixels.clear();
+            for (int j = tile.y0; j < tile.y1; j++) {
+                for (int i = tile.x0; i < tile.x1; i++)
+                    pixels.push_back(loadPixel(i, j));
+            }
 
-                            float weight = expf(-spaceDist - colorDist);
-                            sum += neighborColor * weight;
-                            weightSum += weight;
-                        }
+            while (true) {
+                paths.clear();
+                for (int p = 0; p < (int)pixels.size(); p++) {
+                    if (!wantsSample(pixels[p]))
+                        continue;
+                    paths.emplace_back();
+                    paths.back().ray = cameraRay(pixels[p].x, pixels[p].y);
+                    paths.back().pixel = p;
+                }
+
+                if (paths.empty())
+                    break;
+
+                PixelCost cost = beginCost();
+                integrator.trace(_maxDepth, world, lights, _skyboxColor, _wavefront, _lightSelection, _lightSamples);
+                for (const PathState& path : paths)
+                    addSample(pixels[path.pixel], path.radiance, path.features);
+
+                if (_aovs.cost) {
+                    PixelCost end = beginCost();
+                    for (const PathState& path : paths)
+                        addCost(pixels[path.pixel].index, cost, end, 1.0f / float(paths.size()));
+                }
+            }
+
+            for (PixelAccumulator& pixel : pixels)
+                storePixel(pixel);
+        }
+
+        void accumulateTile(const RenderTile& tile, const Hittable& world, const RayLightList& lights) {
+            int stride = _progressiveStride;
+            int skip = _progressiveSkip;
+            bool wavefront = _integrator == Integrator::Wavefront;
+            std::vector<PathState>& paths = WavefrontIntegrator::local().paths();
+            paths.clear();
+
+            for (int j = tile.y0 + (stride - tile.y0 % stride) % stride; j < tile.y1; j += stride) {
+                for (int i = tile.x0 + (stride - tile.x0 % stride) % stride; i < tile.x1; i += stride) {
+                    if (skip > 0 && i % skip == 0 && j % skip == 0)
+                        continue;
+
+                    if (wavefront) {
+                        paths.emplace_back();
+                        paths.back().ray = cameraRay(i, j);
+                        paths.back().pixel = _buffers.index(i, j);
+                        continue;
+                    }
+
+                    PixelCost cost = beginCost();
+                    SampleFeatures features;
+                    Color sample = rayColor(cameraRay(i, j), _maxDepth, world, lights, &features);
+
+                    int index = _buffers.index(i, j);
+                    accumulateSample(index, sample, features);
+                    if (_aovs.cost) endCost(cost, index);
+                }
+            }
+
+            if (paths.empty())
+                return;
+
+            PixelCost cost = beginCost();
+            WavefrontIntegrator::local().trace(_maxDepth, world, lights, _skyboxColor, _wavefront, _lightSelection, _lightSamples);
+            for (const PathState& path : paths)
+                accumulateSample(path.pixel, path.radiance, path.features);
+
+            if (_aovs.cost) {
+                PixelCost end = beginCost();
+                for (const PathState& path : paths)
+                    addCost(path.pixel, cost, end, 1.0f / float(paths.size()));
+            }
+        }
+
+        void accumulateSample(int index, const Color& sample, const SampleFeatures& features) {
+            int samplesTaken = ++_buffers.sampleCount[index];
+            if (samplesTaken == 1)
+                RenderStats::count(Counter::Pixels);
+            float weight = 1.0f / float(samplesTaken);
+
+            Color delta = sample - _buffers.color[index];
+            _buffers.color[index] += delta * weight;
+            _buffers.m2[index] += delta * (sample - _buffers.color[index]);
+
+            _buffers.albedo[index] += (features.albedo - _buffers.albedo[index]) * weight;
+            _buffers.normal[index] += (features.normal - _buffers.normal[index]) * weight;
+            _buffers.depth[index] += (features.depth - _buffers.depth[index]) * weight;
+
+            Color variance = samplesTaken > 1 ? _buffers.m2[index] / float(samplesTaken - 1) : Color(0.0f);
+            _buffers.variance[index] = (variance.x + variance.y + variance.z) / 3.0f * weight;
+
+            if (samplesTaken == 1) {
+                if (_aovs.objectId) _buffers.objectId[index] = features.objectId;
+                if (_aovs.materialId) _buffers.materialId[index] = features.materialId;
+            }
+            if (_aovs.direct) _buffers.direct[index] += (features.direct - _buffers.direct[index]) * weight;
+            if (_aovs.indirect) _buffers.indirect[index] += (features.indirect - _buffers.indirect[index]) * weight;
+        }
+
+        void upsample(int stride) {
+            _upsampled.resize(_buffers.color.size());
+            int lastX = (_imageWidth - 1) / stride * stride;
+            int lastY = (_imageHeight - 1) / stride * stride;
+
+            for (int j = 0; j < _imageHeight; j++) {
+                int y0 = j / stride * stride;
+                int y1 = std::min(y0 + stride, lastY);
+                float fy = y1 > y0 ? float(j - y0) / float(y1 - y0) : 0.0f;
+
+                for (int i = 0; i < _imageWidth; i++) {
+                    int x0 = i / stride * stride;
+                    int x1 = std::min(x0 + stride, lastX);
+                    float fx = x1 > x0 ? float(i - x0) / float(x1 - x0) : 0.0f;
+
+                    int nearest = _buffers.index(fx < 0.5f ? x0 : x1, fy < 0.5f ? y0 : y1);
+                    float referenceDepth = _buffers.depth[nearest];
+                    const glm::vec3& referenceNormal = _buffers.normal[nearest];
+
+                    const int corners[4] = {_buffers.index(x0, y0), _buffers.index(x1, y0), _buffers.index(x0, y1), _buffers.index(x1, y1)};
+                    const float bilinear[4] = {(1.0f - fx) * (1.0f - fy), fx * (1.0f - fy), (1.0f - fx) * fy, fx * fy};
+
+                    Color sum(0.0f);
+                    float weightSum = 0.0f;
+                    for (int k = 0; k < 4; k++) {
+                        int q = corners[k];
+                        float depthWeight = std::exp(-std::abs(_buffers.depth[q] - referenceDepth) / (_upsampleSigmaDepth * referenceDepth + 1e-4f));
+                        float normalWeight = std::max(glm::dot(_buffers.normal[q], referenceNormal), 0.0f);
+                        normalWeight *= normalWeight;
+                        normalWeight *= normalWeight;
+                        normalWeight *= normalWeight;
+                        float weight = bilinear[k] * depthWeight * normalWeight + (q == nearest ? 1e-4f : 0.0f);
+
+                        sum += _buffers.color[q] * weight;
+                        weightSum += weight;
                     }
 
-                    glm::vec3 result = sum / weightSum;
-                    int index = (y * _imageWidth + x) * 3;
-                    output[index] = static_cast<unsigned char>(glm::clamp(result.r * 255.0f, 0.0f, 255.0f));
-                    output[index + 1] = static_cast<unsigned char>(glm::clamp(result.g * 255.0f, 0.0f, 255.0f));
-                    output[index + 2] = static_cast<unsigned char>(glm::clamp(result.b * 255.0f, 0.0f, 255.0f));
+                    _upsampled[_buffers.index(i, j)] = sum / weightSum;
                 }
             }
+        }
+
+        struct PixelCost {
+            std::chrono::steady_clock::time_point start;
+            uint64_t nodes = 0;
+            uint64_t steps = 0;
+        };
+
+        PixelCost beginCost() const {
+            if (!_aovs.cost)
+                return PixelCost();
+            return {std::chrono::steady_clock::now(), RenderStats::local(Counter::BVHNodes), RenderStats::local(Counter::SDFSteps)};
+        }
 
-            std::copy(output.begin(), output.end(), imageDataBuffer);
+        void endCost(const PixelCost& cost, int index) {
+            addCost(index, cost, beginCost(), 1.0f);
         }
 
-        glm::vec3 getPixel(int x, int y) const {
-            int index = (y * _imageWidth + x) * 3;
-            return glm::vec3(
-                imageDataBuffer[index]     / 255.0f,
-                imageDataBuffer[index + 1] / 255.0f,
-                imageDataBuffer[index + 2] / 255.0f
-            );
+        void addCost(int index, const PixelCost& start, const PixelCost& end, float share) {
+            _buffers.costTime[index] += share * std::chrono::duration<float, std::micro>(end.start - start.start).count();
+            _buffers.costNodes[index] += share * float(end.nodes - start.nodes);
+            _buffers.costSteps[index] += share * float(end.steps - start.steps);
         }
 
-        Color rayColor(const Ray& ray, int depth, const Hittable& world, const RayLightList& lights) const {
+        RenderTile denoiseTarget() const {
+            return hasRegion() ? _region.intersect(_buffers.window()) : _buffers.window();
+        }
+
+        void showDenoised() {
+            if (hasRegion())
+                writeDisplay(denoiseTarget());
+            else
+                updateDisplay();
+        }
+
+        void writeDisplay(const RenderTile& tile) {
+            if (!imageDataBuffer)
+                return;
+            if (_displayMode != DisplayMode::Beauty && writeHeatmap(tile))
+                return;
+            writeDisplay(tile, _denoise ? _buffers.denoised : _buffers.color);
+        }
+
+        template<typename T>
+        void writeHeatmap(const RenderTile& tile, const BufferVector<T>& source) {
+            bool fullFrame = tile.width() == _buffers.window().width() && tile.height() == _buffers.window().height();
+
+            float tileMax = 0.0f;
+            for (int j = tile.y0; j < tile.y1; j++)
+                tileMax = std::max(tileMax, Heatmap::maxValue(&source[_buffers.index(tile.x0, j)], tile.width()));
+
+            float maxValue = tileMax;
+            if (fullFrame) {
+                _heatmapMax.store(tileMax);
+            } else {
+                float current = _heatmapMax.load();
+                while (tileMax > current && !_heatmapMax.compare_exchange_weak(current, tileMax)) {}
+                maxValue = std::max(current, tileMax);
+            }
+
+            for (int j = tile.y0; j < tile.y1; j++) {
+                Heatmap::apply(&source[_buffers.index(tile.x0, j)], tile.width(), maxValue, displayRow(tile.x0, j));
+            }
+        }
+
+        bool writeHeatmap(const RenderTile& tile) {
+            if (_displayMode == DisplayMode::Samples)
+                writeHeatmap(tile, _buffers.sampleCount);
+            else if (_buffers.costTime.empty())
+                return false;
+            else if (_displayMode == DisplayMode::Time)
+                writeHeatmap(tile, _buffers.costTime);
+            else if (_displayMode == DisplayMode::BVHNodes)
+                writeHeatmap(tile, _buffers.costNodes);
+            else
+                writeHeatmap(tile, _buffers.costSteps);
+            return true;
+        }
+
+        void writeDisplay(const RenderTile& tile, const BufferVector<Color>& source) {
+            for (int j = tile.y0; j < tile.y1; j++) {
+                _tonemapper.apply(&source[_buffers.index(tile.x0, j)], tile.width(), displayRow(tile.x0, j));
+            }
+        }
+
+        unsigned char* displayRow(int x, int y) const {
+            return imageDataBuffer + (size_t(y) * _imageWidth + x) * 3;
+        }
+
+        Color rayColor(const Ray& ray, int depth, const Hittable& world, const RayLightList& lights, SampleFeatures* features = nullptr, float scatterPdf = 0.0f) const {
             if (depth <= 0)
                 return Color(0.0f, 0.0f, 0.0f);
 
             HitRecord rec;
             if (world.raymarch(ray, rec)) {
+                RenderStats::count(Counter::PathVertices);
                 Color resultColor(0.0f);
 
-                for (const auto& lightPtr : lights.lights) {
-                    const RayLight& light = *lightPtr;
+                if (features) {
+                    features->albedo = rec.material->albedo();
+                    features->normal = rec.normal;
+                    features->depth = glm::length(rec.point - ray.origin());
+                    features->objectId = rec.objectId;
+                    features->materialId = rec.material->id();
+                }
+
+                static thread_local std::vector<LightChoice> choices;
+                static thread_local std::vector<LightSample> samples;
+                LightSampler::select(lights, rec.point, _lightSelection, _lightSamples, choices);
+                lights.evaluate(rec.point, choices, samples);
+                for (size_t i = 0; i < choices.size(); i++) {
+                    const LightSample& sample = samples[i];
+                    if (sample.radiance == Color(0.0f))
+                        continue;
 
-                    glm::vec3 lightDir = glm::normalize(light.directionFrom(rec.point));
+                    glm::vec3 lightDir = sample.direction;
                     float biasAmount = 0.1f;
                     glm::vec3 shadowOrigin = rec.point + rec.normal * biasAmount;
 
                     float lightDist;
-                    if (light.isFinite()) {
+                    if (sample.finite) {
                         float projectedBias = glm::dot(rec.normal * biasAmount, lightDir);
-                        lightDist = light.distanceFrom(rec.point) - projectedBias;
+                        lightDist = sample.distance - projectedBias;
                     } else {
                         lightDist = 100.0f;
                     }
 
+                    RenderStats::count(Counter::ShadowRays);
                     Ray shadowRay(shadowOrigin, lightDir);
                     bool inShadow = world.shadowMarch(shadowRay, lightDist);
 
                     if (!inShadow) {
-                        resultColor += rec.material->shade(ray, rec, lightDir, light);
+                        resultColor += rec.material->shade(ray, rec, lightDir, sample.radiance) * choices[i].weight;
                     }
                 }
 
+                if (depth > 1 && _skyboxColor != Color(0.0f)) {
+                    glm::vec3 skyDir = randomOnHemisphere(rec.normal);
+                    Color shaded = rec.material->shade(ray, rec, skyDir, _skyboxColor);
+                    if (shaded != Color(0.0f)) {
+                        RenderStats::count(Counter::ShadowRays);
+                        if (!world.shadowMarch(Ray(rec.point + rec.normal * 0.1f, skyDir), 100.0f))
+                            resultColor += shaded * powerHeuristic(uniformHemispherePdf, rec.material->pdf(ray, rec, skyDir)) / uniformHemispherePdf;
+                    }
+                }
+
+                if (features)
+                    features->direct = resultColor;
+
                 Ray scattered;
                 Color attenuation;
-                if (rec.material->scatter(ray, rec, attenuation, scattered)) {
-                    resultColor += attenuation * rayColor(scattered, depth - 1, world, lights);
+                float pdf;
+                if (rec.material->scatter(ray, rec, attenuation, scattered, pdf)) {
+                    RenderStats::count(Counter::ScatterRays);
+                    Color indirect = attenuation * rayColor(scattered, depth - 1, world, lights, nullptr, pdf);
+                    resultColor += indirect;
+
+                    if (features)
+                        features->indirect = indirect;
                 }
 
                 return resultColor;
             }
 
+            if (features)
+                features->direct = _skyboxColor;
+
+            if (scatterPdf > 0.0f)
+                return _skyboxColor * powerHeuristic(scatterPdf, uniformHemispherePdf);
             return _skyboxColor;
         }
 };
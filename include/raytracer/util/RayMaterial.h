@@ -9,14 +9,27 @@ class RayMaterial {
     public:
         virtual ~RayMaterial() = default;
 
-        virtual bool scatter(const Ray& inRay, const HitRecord& rec, Color& attenuation, Ray& scatteredRay) const {
+        virtual bool scatter(const Ray& inRay, const HitRecord& rec, Color& attenuation, Ray& scatteredRay, float& scatterPdf) const {
             return false;
         }
 
-        virtual Color shade(const Ray& inRay, const HitRecord& rec, const glm::vec3& lightDir, const RayLight& light) const {
+        virtual float pdf(const Ray& inRay, const HitRecord& rec, const glm::vec3& direction) const {
+            return 0.0f;
+        }
+
+        virtual Color shade(const Ray& inRay, const HitRecord& rec, const glm::vec3& lightDir, const Color& radiance) const {
             float nDotL = glm::max(glm::dot(rec.normal, glm::normalize(lightDir)), 0.0f);
-            return Color(1.0f) * light.intensityAt(rec.point) * nDotL / glm::pi<float>();
+            return Color(1.0f) * radiance * nDotL / glm::pi<float>();
         }
+
+        virtual Color albedo() const {
+            return Color(1.0f);
+        }
+
+        int& id() { return _id; }
+        int id() const { return _id; }
+    protected:
+        int _id = -1;
 };
 
 class PBR : public RayMaterial {
@@ -26,7 +39,7 @@ class PBR : public RayMaterial {
               _metallic(glm::clamp(metallic, 0.0f, 1.0f)),
               _roughness(glm::clamp(roughness, 0.05f, 1.0f)) {}
 
-        Color shade(const Ray& inRay, const HitRecord& rec, const glm::vec3& lightDir, const RayLight& light) const override {
+        Color shade(const Ray& inRay, const HitRecord& rec, const glm::vec3& lightDir, const Color& radiance) const override {
             glm::vec3 N = glm::normalize(rec.normal);
             glm::vec3 V = glm::normalize(-inRay.direction());
             glm::vec3 L = glm::normalize(lightDir);
@@ -49,35 +62,48 @@ class PBR : public RayMaterial {
             float denominator = 4.0f * glm::max(glm::dot(N, V), 0.0f) * glm::max(glm::dot(N, L), 0.0f) + 1e-4f;
             glm::vec3 specular = numerator / denominator;
 
-            Color radiance = light.intensityAt(rec.point);
-
             return (kD * _albedo / glm::pi<float>() + specular) * radiance * NdotL;
         }
 
-        bool scatter(const Ray& inRay, const HitRecord& rec, Color& attenuation, Ray& scatteredRay) const override {
-            glm::vec3 N = rec.normal;
+        bool scatter(const Ray& inRay, const HitRecord& rec, Color& attenuation, Ray& scatteredRay, float& scatterPdf) const override {
+            glm::vec3 N = glm::normalize(rec.normal);
             glm::vec3 V = glm::normalize(-inRay.direction());
-
-            Color F0 = glm::mix(Color(0.04f), _albedo, _metallic);
-            glm::vec3 F = fresnelSchlick(glm::max(glm::dot(N, V), 0.0f), F0);
-
-            float specularChance = glm::max(F.r, glm::max(F.g, F.b));
+            if (glm::dot(N, V) <= 0.0f) return false;
 
             glm::vec3 dir;
-            if (randomFloat() < specularChance) {
-                glm::vec3 R = reflect(glm::normalize(inRay.direction()), N);
-                dir = glm::normalize(R + _roughness * _roughness * randomOnHemisphere(N));
-                attenuation = F / specularChance;
-            } else {
+            if (randomFloat() < specularProbability(N, V))
+                dir = reflect(-V, sampleVisibleNormal(N, V, _roughness));
+            else
                 dir = randomCosineHemisphere(N);
-                glm::vec3 kD = (glm::vec3(1.0f) - F) * (1.0f - _metallic);
-                attenuation = kD * _albedo / (1.0f - specularChance);
-            }
 
-            if (glm::dot(dir, N) <= 0.0f) dir = N;
+            scatterPdf = pdf(inRay, rec, dir);
+            if (scatterPdf <= 0.0f) return false;
+
+            attenuation = shade(inRay, rec, dir, Color(1.0f)) / scatterPdf;
             scatteredRay = Ray(rec.point + N * 0.001f, dir);
             return true;
         }
+
+        float pdf(const Ray& inRay, const HitRecord& rec, const glm::vec3& direction) const override {
+            glm::vec3 N = glm::normalize(rec.normal);
+            glm::vec3 V = glm::normalize(-inRay.direction());
+            glm::vec3 L = glm::normalize(direction);
+
+            float NdotL = glm::dot(N, L);
+            float NdotV = glm::dot(N, V);
+            if (NdotL <= 0.0f || NdotV <= 0.0f) return 0.0f;
+
+            glm::vec3 H = glm::normalize(V + L);
+            float specular = DistributionGGX(N, H, _roughness) * SmithG1(NdotV, _roughness) / (4.0f * NdotV);
+            float diffuse = NdotL / glm::pi<float>();
+
+            float specularChance = specularProbability(N, V);
+            return specularChance * specular + (1.0f - specularChance) * diffuse;
+        }
+
+        Color albedo() const override {
+            return _albedo;
+        }
     private:
         Color _albedo;
         float _metallic;
@@ -114,6 +140,45 @@ class PBR : public RayMaterial {
         glm::vec3 fresnelSchlick(float cosTheta, glm::vec3 F0) const {
             return F0 + (1.0f - F0) * powf(1.0f - cosTheta, 5.0f);
         }
+
+        float SmithG1(float NdotV, float a) const {
+            float a2 = a * a;
+            return 2.0f * NdotV / (NdotV + std::sqrt(a2 + (1.0f - a2) * NdotV * NdotV));
+        }
+
+        float specularProbability(glm::vec3 N, glm::vec3 V) const {
+            Color F0 = glm::mix(Color(0.04f), _albedo, _metallic);
+            glm::vec3 F = fresnelSchlick(glm::max(glm::dot(N, V), 0.0f), F0);
+            glm::vec3 kD = (glm::vec3(1.0f) - F) * (1.0f - _metallic);
+
+            float specular = glm::max(F.r, glm::max(F.g, F.b));
+            float diffuse = glm::max(kD.r * _albedo.r, glm::max(kD.g * _albedo.g, kD.b * _albedo.b));
+            return specular / glm::max(specular + diffuse, 1e-6f);
+        }
+
+        glm::vec3 sampleVisibleNormal(glm::vec3 N, glm::vec3 V, float a) const {
+            glm::vec3 up = std::fabs(N.z) < 0.999f ? glm::vec3(0, 0, 1) : glm::vec3(1, 0, 0);
+            glm::vec3 tangent = glm::normalize(glm::cross(up, N));
+            glm::vec3 bitangent = glm::cross(N, tangent);
+
+            glm::vec3 Vl(glm::dot(V, tangent), glm::dot(V, bitangent), glm::dot(V, N));
+            glm::vec3 Vh = glm::normalize(glm::vec3(a * Vl.x, a * Vl.y, Vl.z));
+
+            float lensq = Vh.x * Vh.x + Vh.y * Vh.y;
+            glm::vec3 T1 = lensq > 0.0f ? glm::vec3(-Vh.y, Vh.x, 0.0f) / std::sqrt(lensq) : glm::vec3(1.0f, 0.0f, 0.0f);
+            glm::vec3 T2 = glm::cross(Vh, T1);
+
+            float r = std::sqrt(randomFloat());
+            float phi = 2.0f * glm::pi<float>() * randomFloat();
+            float t1 = r * std::cos(phi);
+            float t2 = r * std::sin(phi);
+            float s = 0.5f * (1.0f + Vh.z);
+            t2 = (1.0f - s) * std::sqrt(glm::max(1.0f - t1 * t1, 0.0f)) + s * t2;
+
+            glm::vec3 Nh = t1 * T1 + t2 * T2 + std::sqrt(glm::max(1.0f - t1 * t1 - t2 * t2, 0.0f)) * Vh;
+            glm::vec3 Hl = glm::normalize(glm::vec3(a * Nh.x, a * Nh.y, glm::max(Nh.z, 0.0f)));
+            return glm::normalize(tangent * Hl.x + bitangent * Hl.y + N * Hl.z);
+        }
 };
 
 #endif
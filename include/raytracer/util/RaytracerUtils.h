@@ -6,16 +6,26 @@
 #include <iostream>
 #include <cstdlib>
 #include <random>
+#include <cstdint>
 #include <memory>
 #include <limits>
 
 #include "Ray.h"
 #include "Interval.h"
 
+inline std::mt19937& randomGenerator() {
+    static thread_local std::mt19937 generator(std::random_device{}());
+    return generator;
+}
+
+inline void seedRandom(uint64_t seed) {
+    std::seed_seq sequence{uint32_t(seed), uint32_t(seed >> 32)};
+    randomGenerator().seed(sequence);
+}
+
 inline float randomFloat() {
     static std::uniform_real_distribution<float> distribution(0.0, 1.0);
-    static thread_local std::mt19937 generator(std::random_device{}());
-    return distribution(generator);
+    return distribution(randomGenerator());
 }
 
 inline float randomFloat(float min, float max) {
@@ -31,12 +41,10 @@ inline glm::vec3 randomVec3(float min, float max) {
 }
 
 inline glm::vec3 randomUnitVector() {
-    while (true) {
-        glm::vec3 p = randomVec3(-1.0f, 1.0f);
-        float lensq = glm::dot(p, p);
-        if (1e-160 < lensq && lensq <= 1)
-            return p / std::sqrt(lensq);
-    }
+    float z = 1.0f - 2.0f * randomFloat();
+    float r = std::sqrt(std::max(1.0f - z * z, 0.0f));
+    float phi = 2.0f * glm::pi<float>() * randomFloat();
+    return glm::vec3(r * std::cos(phi), r * std::sin(phi), z);
 }
 
 inline glm::vec3 randomOnHemisphere(const glm::vec3& normal) {
@@ -65,11 +73,10 @@ inline glm::vec3 randomCosineHemisphere(const glm::vec3& normal) {
     return glm::normalize(tangent * x + bitangent * y + normal * z);
 }
 
-inline float linearToGamma(float linearComponent) {
-    if (linearComponent > 0)
-        return std::sqrt(linearComponent);
+const float uniformHemispherePdf = 0.5f / glm::pi<float>();
 
-    return 0.0f;
+inline float powerHeuristic(float pdf, float otherPdf) {
+    return pdf * pdf / (pdf * pdf + otherPdf * otherPdf);
 }
 
 inline bool isVectorNearZero(glm::vec3& vector) {
@@ -0,0 +1,270 @@
+#ifndef RENDERBUFFERS_H
+#define RENDERBUFFERS_H
+
+#include "RaytracerUtils.h"
+#include "ByteStream.h"
+#include "FirstTouchAllocator.h"
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+
+struct RenderTile {
+    int x0, y0, x1, y1;
+
+    int width() const { return x1 - x0; }
+    int height() const { return y1 - y0; }
+    bool empty() const { return x1 <= x0 || y1 <= y0; }
+
+    RenderTile intersect(const RenderTile& other) const {
+        return {std::max(x0, other.x0), std::max(y0, other.y0), std::min(x1, other.x1), std::min(y1, other.y1)};
+    }
+
+    bool operator==(const RenderTile& other) const {
+        return x0 == other.x0 && y0 == other.y0 && x1 == other.x1 && y1 == other.y1;
+    }
+};
+
+struct SampleFeatures {
+    Color albedo{0.0f};
+    glm::vec3 normal{0.0f};
+    float depth = 0.0f;
+    int objectId = -1;
+    int materialId = -1;
+    Color direct{0.0f};
+    Color indirect{0.0f};
+};
+
+struct AOVSettings {
+    bool depth = true;
+    bool normal = true;
+    bool albedo = true;
+    bool objectId = false;
+    bool materialId = false;
+    bool sampleCount = false;
+    bool direct = false;
+    bool indirect = false;
+    bool cost = false;
+
+    bool operator==(const AOVSettings& other) const {
+        return depth == other.depth && normal == other.normal && albedo == other.albedo && objectId == other.objectId
+            && materialId == other.materialId && sampleCount == other.sampleCount && direct == other.direct
+            && indirect == other.indirect && cost == other.cost;
+    }
+};
+
+struct TileFlag {
+    std::atomic<bool> value{false};
+
+    TileFlag() = default;
+    TileFlag(const TileFlag& other) : value(other.value.load()) {}
+    TileFlag& operator=(const TileFlag& other) {
+        value.store(other.value.load());
+        return *this;
+    }
+};
+
+struct BufferChannel {
+    const char* name;
+    void* data;
+    size_t elementSize;
+};
+
+class RenderBuffers {
+    public:
+        BufferVector<Color> color;
+        BufferVector<Color> m2;
+        BufferVector<Color> albedo;
+        BufferVector<glm::vec3> normal;
+        BufferVector<float> depth;
+        BufferVector<float> variance;
+        BufferVector<Color> denoised;
+        BufferVector<int> sampleCount;
+        BufferVector<int> objectId;
+        BufferVector<int> materialId;
+        BufferVector<Color> direct;
+        BufferVector<Color> indirect;
+        BufferVector<float> costTime;
+        BufferVector<float> costNodes;
+        BufferVector<float> costSteps;
+
+        void resize(int width, int height, int tileSize, const AOVSettings& aovs = AOVSettings()) {
+            resize(width, height, {0, 0, width, height}, tileSize, aovs);
+        }
+
+        void resize(int width, int height, const RenderTile& window, int tileSize, const AOVSettings& aovs = AOVSettings(), bool firstTouch = false) {
+            _width = width;
+            _height = height;
+            _window = window;
+            _tileSize = tileSize;
+            _firstTileX = window.x0 / tileSize;
+            _firstTileY = window.y0 / tileSize;
+            _tilesX = (window.x1 + tileSize - 1) / tileSize - _firstTileX;
+            _tilesY = (window.y1 + tileSize - 1) / tileSize - _firstTileY;
+
+            size_t pixelCount = this->pixelCount();
+            allocate(color, pixelCount, Color(0.0f), firstTouch);
+            allocate(m2, pixelCount, Color(0.0f), firstTouch);
+            allocate(albedo, pixelCount, Color(0.0f), firstTouch);
+            allocate(normal, pixelCount, glm::vec3(0.0f), firstTouch);
+            allocate(depth, pixelCount, 0.0f, firstTouch);
+            allocate(variance, pixelCount, 0.0f, firstTouch);
+            allocate(denoised, pixelCount, Color(0.0f), firstTouch);
+            allocate(sampleCount, pixelCount, 0, firstTouch);
+
+            _aovs = aovs;
+            allocate(objectId, aovs.objectId ? pixelCount : 0, -1, firstTouch);
+            allocate(materialId, aovs.materialId ? pixelCount : 0, -1, firstTouch);
+            allocate(direct, aovs.direct ? pixelCount : 0, Color(0.0f), firstTouch);
+            allocate(indirect, aovs.indirect ? pixelCount : 0, Color(0.0f), firstTouch);
+            allocate(costTime, aovs.cost ? pixelCount : 0, 0.0f, firstTouch);
+            allocate(costNodes, aovs.cost ? pixelCount : 0, 0.0f, firstTouch);
+            allocate(costSteps, aovs.cost ? pixelCount : 0, 0.0f, firstTouch);
+
+            _tiles.clear();
+            for (int ty = _firstTileY + _tilesY - 1; ty >= _firstTileY; ty--) {
+                for (int tx = _firstTileX; tx < _firstTileX + _tilesX; tx++) {
+                    int x0 = tx * tileSize;
+                    int y0 = ty * tileSize;
+                    _tiles.push_back({std::max(x0, window.x0), std::max(y0, window.y0), std::min(x0 + tileSize, window.x1), std::min(y0 + tileSize, window.y1)});
+                }
+            }
+
+            _tileFinished.assign(_tilesX * _tilesY, TileFlag());
+        }
+
+        std::vector<RenderTile> tilesIn(const RenderTile& region) const {
+            std::vector<RenderTile> result;
+            for (const RenderTile& tile : _tiles) {
+                RenderTile clipped = tile.intersect(region);
+                if (!clipped.empty())
+                    result.push_back(clipped);
+            }
+            return result;
+        }
+
+        void clearTile(const RenderTile& tile) {
+            fillTile(color, tile, Color(0.0f));
+            fillTile(m2, tile, Color(0.0f));
+            fillTile(albedo, tile, Color(0.0f));
+            fillTile(normal, tile, glm::vec3(0.0f));
+            fillTile(depth, tile, 0.0f);
+            fillTile(variance, tile, 0.0f);
+            fillTile(denoised, tile, Color(0.0f));
+            fillTile(sampleCount, tile, 0);
+            fillTile(objectId, tile, -1);
+            fillTile(materialId, tile, -1);
+            fillTile(direct, tile, Color(0.0f));
+            fillTile(indirect, tile, Color(0.0f));
+            fillTile(costTime, tile, 0.0f);
+            fillTile(costNodes, tile, 0.0f);
+            fillTile(costSteps, tile, 0.0f);
+        }
+
+        void markTileFinished(const RenderTile& tile) {
+            _tileFinished[tileIndex(tile.x0, tile.y0)].value.store(true, std::memory_order_release);
+        }
+
+        void markTileUnfinished(const RenderTile& tile) {
+            _tileFinished[tileIndex(tile.x0, tile.y0)].value.store(false, std::memory_order_release);
+        }
+
+        bool isPixelFinished(int x, int y) const {
+            return _tileFinished[tileIndex(x, y)].value.load(std::memory_order_acquire);
+        }
+
+        std::vector<BufferChannel> channels() {
+            std::vector<BufferChannel> result;
+            addChannel(result, "color", color);
+            addChannel(result, "m2", m2);
+            addChannel(result, "sampleCount", sampleCount);
+            addChannel(result, "albedo", albedo);
+            addChannel(result, "normal", normal);
+            addChannel(result, "depth", depth);
+            addChannel(result, "variance", variance);
+            addChannel(result, "objectId", objectId);
+            addChannel(result, "materialId", materialId);
+            addChannel(result, "direct", direct);
+            addChannel(result, "indirect", indirect);
+            addChannel(result, "costTime", costTime);
+            addChannel(result, "costNodes", costNodes);
+            addChannel(result, "costSteps", costSteps);
+            return result;
+        }
+
+        void writeTile(const RenderTile& tile, ByteWriter& writer) {
+            for (const BufferChannel& channel : channels()) {
+                const char* data = static_cast<const char*>(channel.data);
+                for (int j = tile.y0; j < tile.y1; j++)
+                    writer.writeBytes(data + size_t(index(tile.x0, j)) * channel.elementSize, tile.width() * channel.elementSize);
+            }
+        }
+
+        size_t tileBytes(const RenderTile& tile) {
+            size_t pixelBytes = 0;
+            for (const BufferChannel& channel : channels())
+                pixelBytes += channel.elementSize;
+            return pixelBytes * size_t(tile.width()) * tile.height();
+        }
+
+        bool readTile(const RenderTile& tile, ByteReader& reader) {
+            for (const BufferChannel& channel : channels()) {
+                char* data = static_cast<char*>(channel.data);
+                for (int j = tile.y0; j < tile.y1; j++) {
+                    if (!reader.readBytes(data + size_t(index(tile.x0, j)) * channel.elementSize, tile.width() * channel.elementSize))
+                        return false;
+                }
+            }
+            return true;
+        }
+
+        int index(int x, int y) const { return (y - _window.y0) * _window.width() + (x - _window.x0); }
+        int width() const { return _width; }
+        int height() const { return _height; }
+        const RenderTile& window() const { return _window; }
+        size_t pixelCount() const { return size_t(_window.width()) * _window.height(); }
+        int tileSize() const { return _tileSize; }
+        const std::vector<RenderTile>& tiles() const { return _tiles; }
+        const AOVSettings& aovs() const { return _aovs; }
+    private:
+        int _width = 0;
+        int _height = 0;
+        RenderTile _window = {0, 0, 0, 0};
+        int _tileSize = 32;
+        int _firstTileX = 0;
+        int _firstTileY = 0;
+        int _tilesX = 0;
+        int _tilesY = 0;
+
+        AOVSettings _aovs;
+        std::vector<RenderTile> _tiles;
+        std::vector<TileFlag> _tileFinished;
+
+        template<typename T>
+        static void allocate(BufferVector<T>& data, size_t count, const T& value, bool firstTouch) {
+            if (firstTouch)
+                data = BufferVector<T>(count);
+            else
+                data.assign(count, value);
+        }
+
+        template<typename T>
+        void fillTile(BufferVector<T>& data, const RenderTile& tile, const T& value) {
+            if (data.empty())
+                return;
+            for (int j = tile.y0; j < tile.y1; j++)
+                std::fill_n(data.begin() + index(tile.x0, j), tile.width(), value);
+        }
+
+        template<typename T>
+        static void addChannel(std::vector<BufferChannel>& channels, const char* name, BufferVector<T>& data) {
+            if (!data.empty())
+                channels.push_back({name, data.data(), sizeof(T)});
+        }
+
+        int tileIndex(int x, int y) const {
+            return (y / _tileSize - _firstTileY) * _tilesX + (x / _tileSize - _firstTileX);
+        }
+};
+
+#endif
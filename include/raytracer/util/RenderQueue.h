@@ -0,0 +1,362 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <functional>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "Topology.h"
+#include "Arena.h"
+
+enum class RenderJobState {
+    Queued,
+    Running,
+    Finished,
+    Cancelled,
+    END
+};
+
+inline constexpr const char* renderJobStateNames[] = { "QUEUED", "RUNNING", "FINISHED", "CANCELLED" };
+
+class RenderTask {
+    public:
+        virtual ~RenderTask() = default;
+
+        virtual int begin() = 0;
+        virtual void renderTile(int index) = 0;
+        virtual void end(bool cancelled) = 0;
+
+        virtual bool wantsPause() { return false; }
+        virtual void pause() {}
+
+        virtual int passes() { return 0; }
+        virtual int beginPass(int pass) { return 0; }
+        virtual void renderPass(int pass, int index) {}
+};
+
+class RenderQueue;
+
+class RenderJob {
+    public:
+        void cancel();
+        void setPriority(int priority);
+
+        bool wait() const { return _result.get(); }
+        bool done() const { return _result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+        const std::shared_future<bool>& result() const { return _result; }
+
+        uint64_t id() const { return _id; }
+        int priority() const { return _priority.load(); }
+        RenderJobState state() const { return _state.load(); }
+        int finishedTiles() const { return _finishedTiles.load(); }
+        int tileCount() const { return _tileCount.load(); }
+
+        float progress() const {
+            int count = tileCount();
+            return count > 0 ? float(finishedTiles()) / float(count) : 0.0f;
+        }
+    private:
+        friend class RenderQueue;
+
+        RenderQueue* _queue = nullptr;
+        std::shared_ptr<RenderTask> _task;
+        std::function<void(const RenderJob&)> _onProgress;
+        std::promise<bool> _promise;
+        std::shared_future<bool> _result;
+        uint64_t _id = 0;
+        std::atomic<int> _priority = 0;
+        std::atomic<RenderJobState> _state = RenderJobState::Queued;
+        std::atomic<int> _finishedTiles = 0;
+        std::atomic<int> _tileCount = 0;
+
+        bool _cancelled = false;
+        bool _busy = false;
+        bool _pauseRequested = false;
+        std::vector<int> _chunkNext;
+        std::vector<int> _chunkEnd;
+        int _dispatched = 0;
+        int _inFlight = 0;
+        int _passCount = 0;
+        int _pass = 0;
+        int _passSize = 0;
+        int _passNext = 0;
+};
+
+using RenderJobHandle = std::shared_ptr<RenderJob>;
+
+class RenderQueue {
+    public:
+        explicit RenderQueue(int threads = 0, const Topology& topology = Topology::system()) : _topology(topology) {
+            int count = threads > 0 ? threads : std::max((int)std::thread::hardware_concurrency(), 1);
+            for (int i = 0; i < count; i++)
+                _workers.emplace_back([this, i]() { work(_topology.workerNode(i)); });
+        }
+
+        ~RenderQueue() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stopping = true;
+                for (const RenderJobHandle& job : _jobs)
+                    job->_cancelled = true;
+            }
+            _condition.notify_all();
+
+            for (auto& worker : _workers)
+                worker.join();
+        }
+
+        RenderQueue(const RenderQueue&) = delete;
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        RenderJobHandle submit(std::shared_ptr<RenderTask> task, int priority = 0, std::function<void(const RenderJob&)> onProgress = nullptr) {
+            auto job = std::make_shared<RenderJob>();
+            job->_queue = this;
+            job->_task = std::move(task);
+            job->_onProgress = std::move(onProgress);
+            job->_result = job->_promise.get_future().share();
+            job->_priority = priority;
+
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                job->_id = _nextId++;
+                job->_cancelled = _stopping;
+                _jobs.insert(std::upper_bound(_jobs.begin(), _jobs.end(), job, runsBefore), job);
+            }
+            _condition.notify_all();
+            return job;
+        }
+
+        void cancelAll() {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                for (const RenderJobHandle& job : _jobs)
+                    job->_cancelled = true;
+            }
+            _condition.notify_all();
+        }
+
+        std::vector<RenderJobHandle> jobs() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _jobs;
+        }
+
+        size_t pending() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _jobs.size();
+        }
+
+        bool setPinning(bool pinned) {
+            std::vector<int> allCpus = _topology.allCpus();
+            bool applied = true;
+            for (size_t i = 0; i < _workers.size(); i++)
+                applied = Topology::pin(_workers[i].native_handle(), pinned ? std::vector<int>{_topology.workerCpu((int)i)} : allCpus) && applied;
+            _pinned = pinned && applied;
+            return applied;
+        }
+
+        bool pinned() const { return _pinned; }
+        int threadCount() const { return (int)_workers.size(); }
+        int nodeCount() const { return _topology.nodeCount(); }
+        const Topology& topology() const { return _topology; }
+
+        static int workerNode() { return _workerNode; }
+
+        static RenderQueue& shared() {
+            static RenderQueue queue;
+            return queue;
+        }
+    private:
+        friend class RenderJob;
+
+        enum class Step { None, Begin, Tile, Pause, Pass, PassTile, End };
+
+        inline static thread_local int _workerNode = 0;
+
+        Topology _topology;
+        std::vector<std::thread> _workers;
+        std::atomic<bool> _pinned = false;
+        std::vector<RenderJobHandle> _jobs;
+        mutable std::mutex _mutex;
+        std::condition_variable _condition;
+        uint64_t _nextId = 0;
+        bool _stopping = false;
+
+        static bool runsBefore(const RenderJobHandle& a, const RenderJobHandle& b) {
+            int pa = a->_priority.load(), pb = b->_priority.load();
+            return pa > pb || (pa == pb && a->_id < b->_id);
+        }
+
+        Step next(int node, RenderJobHandle& job, int& tile) {
+            for (const RenderJobHandle& candidate : _jobs) {
+                RenderJob& j = *candidate;
+                if (j._busy)
+                    continue;
+
+                job = candidate;
+                if (j._state == RenderJobState::Queued)
+                    return j._cancelled ? Step::End : Step::Begin;
+
+                if (j._cancelled || j._dispatched >= j._tileCount) {
+                    if (!j._cancelled && j._passNext < j._passSize) {
+                        tile = j._passNext++;
+                        j._inFlight++;
+                        return Step::PassTile;
+                    }
+                    if (j._inFlight == 0)
+                        return !j._cancelled && j._pass < j._passCount ? Step::Pass : Step::End;
+                    continue;
+                }
+
+                if (j._pauseRequested) {
+                    if (j._inFlight == 0)
+                        return Step::Pause;
+                    continue;
+                }
+
+                int chunk = node % (int)j._chunkNext.size();
+                if (j._chunkNext[chunk] >= j._chunkEnd[chunk]) {
+                    for (int k = 0; k < (int)j._chunkNext.size(); k++) {
+                        if (j._chunkEnd[k] - j._chunkNext[k] > j._chunkEnd[chunk] - j._chunkNext[chunk])
+                            chunk = k;
+                    }
+                }
+
+                tile = j._chunkNext[chunk]++;
+                j._dispatched++;
+                j._inFlight++;
+                return Step::Tile;
+            }
+
+            job = nullptr;
+            return Step::None;
+        }
+
+        void split(RenderJob& job, int count) {
+            int chunks = nodeCount();
+            job._chunkNext.resize(chunks);
+            job._chunkEnd.resize(chunks);
+            for (int k = 0; k < chunks; k++) {
+                job._chunkNext[k] = int(int64_t(count) * k / chunks);
+                job._chunkEnd[k] = int(int64_t(count) * (k + 1) / chunks);
+            }
+        }
+
+        void work(int node) {
+            _workerNode = node;
+            std::unique_lock<std::mutex> lock(_mutex);
+            while (true) {
+                RenderJobHandle job;
+                int tile = 0;
+                Step step = next(node, job, tile);
+
+                if (step == Step::None) {
+                    if (_jobs.empty()) {
+                        Arena::scratch().release();
+                        if (_stopping)
+                            return;
+                    }
+                    _condition.wait(lock);
+                    continue;
+                }
+
+                RenderTask& task = *job->_task;
+                int pass = job->_pass;
+
+                if (step == Step::PassTile) {
+                    lock.unlock();
+                    task.renderPass(pass - 1, tile);
+                    lock.lock();
+
+                    job->_inFlight--;
+                    if (job->_inFlight == 0)
+                        _condition.notify_all();
+                    continue;
+                }
+
+                if (step == Step::Tile) {
+                    lock.unlock();
+                    task.renderTile(tile);
+                    bool pause = task.wantsPause();
+                    job->_finishedTiles++;
+                    if (job->_onProgress) job->_onProgress(*job);
+                    lock.lock();
+
+                    job->_inFlight--;
+                    job->_pauseRequested = job->_pauseRequested || pause;
+                    if (job->_inFlight == 0)
+                        _condition.notify_all();
+                    continue;
+                }
+
+                job->_busy = true;
+                bool cancelled = job->_cancelled;
+                bool begun = job->_state != RenderJobState::Queued;
+                lock.unlock();
+
+                if (step == Step::Begin) {
+                    job->_state = RenderJobState::Running;
+                    int count = task.begin();
+                    int passes = count >= 0 ? task.passes() : 0;
+                    lock.lock();
+                    if (count < 0) {
+                        job->_cancelled = true;
+                        count = 0;
+                    }
+                    job->_tileCount = count;
+                    job->_passCount = passes;
+                    split(*job, count);
+                } else if (step == Step::Pause) {
+                    task.pause();
+                    lock.lock();
+                    job->_pauseRequested = false;
+                } else if (step == Step::Pass) {
+                    int count = task.beginPass(pass);
+                    lock.lock();
+                    job->_pass++;
+                    job->_passSize = std::max(count, 0);
+                    job->_passNext = 0;
+                } else {
+                    if (begun)
+                        task.end(cancelled);
+                    job->_state = cancelled ? RenderJobState::Cancelled : RenderJobState::Finished;
+                    if (job->_onProgress) job->_onProgress(*job);
+
+                    std::shared_ptr<RenderTask> finished = std::move(job->_task);
+                    std::function<void(const RenderJob&)> onProgress = std::move(job->_onProgress);
+                    finished.reset();
+                    onProgress = nullptr;
+
+                    lock.lock();
+                    _jobs.erase(std::find(_jobs.begin(), _jobs.end(), job));
+                    job->_promise.set_value(!cancelled);
+                }
+
+                job->_busy = false;
+                _condition.notify_all();
+            }
+        }
+};
+
+inline void RenderJob::cancel() {
+    {
+        std::lock_guard<std::mutex> lock(_queue->_mutex);
+        _cancelled = true;
+    }
+    _queue->_condition.notify_all();
+}
+
+inline void RenderJob::setPriority(int priority) {
+    std::lock_guard<std::mutex> lock(_queue->_mutex);
+    _priority = priority;
+    std::stable_sort(_queue->_jobs.begin(), _queue->_jobs.end(), RenderQueue::runsBefore);
+}
+
+#endif
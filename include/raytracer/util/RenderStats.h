@@ -0,0 +1,144 @@
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+enum class Counter {
+    CameraRays,
+    ScatterRays,
+    ShadowRays,
+    BVHNodes,
+    Triangles,
+    SDFSteps,
+    PathVertices,
+    Paths,
+    Samples,
+    Pixels,
+    OccluderCacheHits,
+    END
+};
+
+inline constexpr const char* counterNames[] = {
+    "cameraRays",
+    "scatterRays",
+    "shadowRays",
+    "bvhNodesVisited",
+    "trianglesTested",
+    "sdfSteps",
+    "pathVertices",
+    "paths",
+    "samples",
+    "pixels",
+    "occluderCacheHits"
+};
+
+struct RenderCounters {
+    uint64_t values[(int)Counter::END] = {};
+    double seconds = 0.0;
+
+    uint64_t operator[](Counter counter) const { return values[(int)counter]; }
+
+    uint64_t rays() const {
+        return values[(int)Counter::CameraRays] + values[(int)Counter::ScatterRays] + values[(int)Counter::ShadowRays];
+    }
+
+    double averagePathLength() const {
+        uint64_t paths = values[(int)Counter::Paths];
+        return paths ? double(values[(int)Counter::PathVertices]) / double(paths) : 0.0;
+    }
+
+    double averageSamplesPerPixel() const {
+        uint64_t pixels = values[(int)Counter::Pixels];
+        return pixels ? double(values[(int)Counter::Samples]) / double(pixels) : 0.0;
+    }
+
+    double megaRaysPerSecond() const {
+        return seconds > 0.0 ? double(rays()) / seconds * 1e-6 : 0.0;
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream file(path);
+        if (!file)
+            return false;
+
+        file << "{\n";
+        for (int i = 0; i < (int)Counter::END; i++)
+            file << "    \"" << counterNames[i] << "\": " << values[i] << ",\n";
+        file << "    \"rays\": " << rays() << ",\n";
+        file << "    \"averagePathLength\": " << averagePathLength() << ",\n";
+        file << "    \"averageSamplesPerPixel\": " << averageSamplesPerPixel() << ",\n";
+        file << "    \"megaRaysPerSecond\": " << megaRaysPerSecond() << ",\n";
+        file << "    \"seconds\": " << seconds << "\n";
+        file << "}\n";
+        return file.good();
+    }
+};
+
+class RenderStats {
+    public:
+        static void count(Counter counter, uint64_t amount = 1) {
+            _local.values[(int)counter] += amount;
+        }
+
+        static uint64_t local(Counter counter) {
+            return _local.values[(int)counter];
+        }
+
+        static RenderCounters takeLocal() {
+            RenderCounters counters = _local;
+            _local = RenderCounters();
+            return counters;
+        }
+
+        void reset() {
+            for (auto& total : _totals)
+                total.store(0, std::memory_order_relaxed);
+            _local = RenderCounters();
+            auto now = std::chrono::steady_clock::now();
+            _start.store(now);
+            _end.store(now);
+            _running = true;
+        }
+
+        void flush() {
+            for (int i = 0; i < (int)Counter::END; i++) {
+                if (_local.values[i]) {
+                    _totals[i].fetch_add(_local.values[i], std::memory_order_relaxed);
+                    _local.values[i] = 0;
+                }
+            }
+        }
+
+        void add(const RenderCounters& counters) {
+            for (int i = 0; i < (int)Counter::END; i++)
+                _totals[i].fetch_add(counters.values[i], std::memory_order_relaxed);
+        }
+
+        void finish() {
+            _end.store(std::chrono::steady_clock::now());
+            _running = false;
+        }
+
+        RenderCounters snapshot() const {
+            RenderCounters counters;
+            for (int i = 0; i < (int)Counter::END; i++)
+                counters.values[i] = _totals[i].load(std::memory_order_relaxed);
+
+            auto end = _running ? std::chrono::steady_clock::now() : _end.load();
+            counters.seconds = std::chrono::duration<double>(end - _start.load()).count();
+            return counters;
+        }
+    private:
+        inline static thread_local RenderCounters _local;
+
+        std::atomic<uint64_t> _totals[(int)Counter::END] = {};
+        std::atomic<std::chrono::steady_clock::time_point> _start{std::chrono::steady_clock::now()};
+        std::atomic<std::chrono::steady_clock::time_point> _end{std::chrono::steady_clock::now()};
+        std::atomic<bool> _running = false;
+};
+
+#endif
@@ -0,0 +1,265 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define RADIANCE_SIMD_SSE2
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define RADIANCE_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+struct Float4 {
+#if defined(RADIANCE_SIMD_SSE2)
+    __m128 v;
+
+    Float4() : v(_mm_setzero_ps()) {}
+    Float4(__m128 value) : v(value) {}
+    Float4(float value) : v(_mm_set1_ps(value)) {}
+
+    static Float4 load(const float* p) { return _mm_loadu_ps(p); }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return _mm_add_ps(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return _mm_sub_ps(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return _mm_mul_ps(a.v, b.v); }
+    friend Float4 operator/(Float4 a, Float4 b) { return _mm_div_ps(a.v, b.v); }
+
+    friend Float4 min(Float4 a, Float4 b) { return _mm_min_ps(a.v, b.v); }
+    friend Float4 max(Float4 a, Float4 b) { return _mm_max_ps(a.v, b.v); }
+    friend Float4 sqrt(Float4 a) { return _mm_sqrt_ps(a.v); }
+    friend Float4 abs(Float4 a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a.v); }
+
+    friend Float4 exp2Floor(Float4 x) {
+        __m128i e = _mm_cvttps_epi32(x.v);
+        return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(e, _mm_set1_epi32(127)), 23));
+    }
+    friend Float4 floor(Float4 x) {
+        __m128 t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+        return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x.v), _mm_set1_ps(1.0f)));
+    }
+
+    friend Float4 exponent(Float4 x) {
+        __m128i bits = _mm_srli_epi32(_mm_castps_si128(x.v), 23);
+        return _mm_cvtepi32_ps(_mm_sub_epi32(_mm_and_si128(bits, _mm_set1_epi32(0xff)), _mm_set1_epi32(127)));
+    }
+    friend Float4 mantissa(Float4 x) {
+        __m128i bits = _mm_and_si128(_mm_castps_si128(x.v), _mm_set1_epi32(0x007fffff));
+        return _mm_castsi128_ps(_mm_or_si128(bits, _mm_set1_epi32(0x3f800000)));
+    }
+
+    friend Float4 operator<(Float4 a, Float4 b) { return _mm_cmplt_ps(a.v, b.v); }
+    friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+    }
+
+    void storeBytes(unsigned char* p) const {
+        __m128i i = _mm_cvtps_epi32(v);
+        i = _mm_packs_epi32(i, i);
+        i = _mm_packus_epi16(i, i);
+        int32_t packed = _mm_cvtsi128_si32(i);
+        std::memcpy(p, &packed, sizeof(packed));
+    }
+#elif defined(RADIANCE_SIMD_NEON)
+    float32x4_t v;
+
+    Float4() : v(vdupq_n_f32(0.0f)) {}
+    Float4(float32x4_t value) : v(value) {}
+    Float4(float value) : v(vdupq_n_f32(value)) {}
+
+    static Float4 load(const float* p) { return vld1q_f32(p); }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return vaddq_f32(a.v, b.v); }
+    friend Float4 operator-(Float4 a, Float4 b) { return vsubq_f32(a.v, b.v); }
+    friend Float4 operator*(Float4 a, Float4 b) { return vmulq_f32(a.v, b.v); }
+    friend Float4 operator/(Float4 a, Float4 b) {
+        float32x4_t r = vrecpeq_f32(b.v);
+        r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+        r = vmulq_f32(vrecpsq_f32(b.v, r), r);
+        return vmulq_f32(a.v, r);
+    }
+
+    friend Float4 min(Float4 a, Float4 b) { return vminq_f32(a.v, b.v); }
+    friend Float4 max(Float4 a, Float4 b) { return vmaxq_f32(a.v, b.v); }
+    friend Float4 sqrt(Float4 a) {
+        float32x4_t safe = vmaxq_f32(a.v, vdupq_n_f32(1e-30f));
+        float32x4_t r = vrsqrteq_f32(safe);
+        r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(safe, r), r), r);
+        r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(safe, r), r), r);
+        return vmulq_f32(a.v, r);
+    }
+    friend Float4 abs(Float4 a) { return vabsq_f32(a.v); }
+
+    friend Float4 exp2Floor(Float4 x) {
+        int32x4_t e = vcvtq_s32_f32(x.v);
+        return vreinterpretq_f32_s32(vshlq_n_s32(vaddq_s32(e, vdupq_n_s32(127)), 23));
+    }
+    friend Float4 floor(Float4 x) {
+        float32x4_t t = vcvtq_f32_s32(vcvtq_s32_f32(x.v));
+        uint32x4_t greater = vcgtq_f32(t, x.v);
+        return vsubq_f32(t, vreinterpretq_f32_u32(vandq_u32(greater, vreinterpretq_u32_f32(vdupq_n_f32(1.0f)))));
+    }
+
+    friend Float4 exponent(Float4 x) {
+        int32x4_t bits = vreinterpretq_s32_u32(vandq_u32(vshrq_n_u32(vreinterpretq_u32_f32(x.v), 23), vdupq_n_u32(0xff)));
+        return vcvtq_f32_s32(vsubq_s32(bits, vdupq_n_s32(127)));
+    }
+    friend Float4 mantissa(Float4 x) {
+        uint32x4_t bits = vandq_u32(vreinterpretq_u32_f32(x.v), vdupq_n_u32(0x007fffff));
+        return vreinterpretq_f32_u32(vorrq_u32(bits, vdupq_n_u32(0x3f800000)));
+    }
+
+    friend Float4 operator<(Float4 a, Float4 b) { return vreinterpretq_f32_u32(vcltq_f32(a.v, b.v)); }
+    friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        return vbslq_f32(vreinterpretq_u32_f32(mask.v), a.v, b.v);
+    }
+
+    void storeBytes(unsigned char* p) const {
+        uint32x4_t i = vcvtq_u32_f32(vaddq_f32(v, vdupq_n_f32(0.5f)));
+        uint16x4_t h = vmovn_u32(i);
+        uint8x8_t b = vmovn_u16(vcombine_u16(h, h));
+        uint32_t packed = vget_lane_u32(vreinterpret_u32_u8(b), 0);
+        std::memcpy(p, &packed, sizeof(packed));
+    }
+#else
+    float v[4];
+
+    Float4() : v{0.0f, 0.0f, 0.0f, 0.0f} {}
+    Float4(float value) : v{value, value, value, value} {}
+
+    static Float4 load(const float* p) { Float4 r; std::memcpy(r.v, p, sizeof(r.v)); return r; }
+    void store(float* p) const { std::memcpy(p, v, sizeof(v)); }
+
+    template<typename F>
+    static Float4 map(Float4 a, Float4 b, F f) {
+        Float4 r;
+        for (int i = 0; i < 4; i++) r.v[i] = f(a.v[i], b.v[i]);
+        return r;
+    }
+
+    friend Float4 operator+(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x + y; }); }
+    friend Float4 operator-(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x - y; }); }
+    friend Float4 operator*(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x * y; }); }
+    friend Float4 operator/(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return x / y; }); }
+
+    friend Float4 min(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return std::min(x, y); }); }
+    friend Float4 max(Float4 a, Float4 b) { return map(a, b, [](float x, float y) { return std::max(x, y); }); }
+    friend Float4 sqrt(Float4 a) { return map(a, a, [](float x, float) { return std::sqrt(x); }); }
+    friend Float4 abs(Float4 a) { return map(a, a, [](float x, float) { return std::fabs(x); }); }
+
+    friend Float4 exp2Floor(Float4 x) {
+        return map(x, x, [](float f, float) {
+            int32_t bits = (static_cast<int32_t>(f) + 127) << 23;
+            float r;
+            std::memcpy(&r, &bits, sizeof(r));
+            return r;
+        });
+    }
+    friend Float4 floor(Float4 x) { return map(x, x, [](float f, float) { return std::floor(f); }); }
+
+    friend Float4 exponent(Float4 x) {
+        return map(x, x, [](float f, float) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            return float(int32_t((bits >> 23) & 0xff) - 127);
+        });
+    }
+    friend Float4 mantissa(Float4 x) {
+        return map(x, x, [](float f, float) {
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            bits = (bits & 0x007fffff) | 0x3f800000;
+            float r;
+            std::memcpy(&r, &bits, sizeof(r));
+            return r;
+        });
+    }
+
+    friend Float4 operator<(Float4 a, Float4 b) {
+        return map(a, b, [](float x, float y) {
+            uint32_t bits = x < y ? 0xffffffffu : 0u;
+            float r;
+            std::memcpy(&r, &bits, sizeof(r));
+            return r;
+        });
+    }
+    friend Float4 select(Float4 mask, Float4 a, Float4 b) {
+        Float4 r;
+        for (int i = 0; i < 4; i++) {
+            uint32_t bits;
+            std::memcpy(&bits, &mask.v[i], sizeof(bits));
+            r.v[i] = bits ? a.v[i] : b.v[i];
+        }
+        return r;
+    }
+
+    void storeBytes(unsigned char* p) const {
+        for (int i = 0; i < 4; i++)
+            p[i] = static_cast<unsigned char>(v[i] + 0.5f);
+    }
+#endif
+
+    static constexpr int width = 4;
+
+    friend Float4 exp2(Float4 x) {
+        Float4 t = max(min(x, Float4(127.0f)), Float4(-126.0f));
+        Float4 i = floor(t);
+        Float4 f = t - i;
+        Float4 p = Float4(1.8775767e-3f);
+        p = p * f + Float4(8.9893397e-3f);
+        p = p * f + Float4(5.5826318e-2f);
+        p = p * f + Float4(2.4015361e-1f);
+        p = p * f + Float4(6.9315308e-1f);
+        p = p * f + Float4(9.9999994e-1f);
+        return p * exp2Floor(i);
+    }
+
+    friend Float4 log2(Float4 x) {
+        Float4 m = mantissa(x);
+        Float4 p = Float4(-3.4436006e-2f);
+        p = p * m + Float4(3.1821337e-1f);
+        p = p * m + Float4(-1.2315303f);
+        p = p * m + Float4(2.5988452f);
+        p = p * m + Float4(-3.3241990f);
+        p = p * m + Float4(3.1157899f);
+        return p * (m - Float4(1.0f)) + exponent(x);
+    }
+
+    friend Float4 pow(Float4 x, float y) {
+        return exp2(log2(x) * Float4(y));
+    }
+
+    friend Float4 expNeg(Float4 x) {
+        return exp2(min(x, Float4(87.0f)) * Float4(-1.44269504f));
+    }
+
+    friend Float4 acos(Float4 x) {
+        Float4 a = min(abs(x), Float4(1.0f));
+        Float4 p = Float4(-1.2624911e-3f);
+        p = p * a + Float4(6.6700901e-3f);
+        p = p * a + Float4(-1.7088126e-2f);
+        p = p * a + Float4(3.0891881e-2f);
+        p = p * a + Float4(-5.0174305e-2f);
+        p = p * a + Float4(8.8978987e-2f);
+        p = p * a + Float4(-2.1459880e-1f);
+        p = p * a + Float4(1.5707963f);
+        Float4 r = p * sqrt(Float4(1.0f) - a);
+        return select(x < Float4(0.0f), Float4(3.14159265f) - r, r);
+    }
+};
+
+inline float expNeg(float x) {
+    return std::exp(-std::min(x, 87.0f));
+}
+
+inline float select(bool mask, float a, float b) {
+    return mask ? a : b;
+}
+
+#endif
@@ -0,0 +1,60 @@
+#ifndef TONEMAPPER_H
+#define TONEMAPPER_H
+
+#include "RaytracerUtils.h"
+#include "Simd.h"
+
+enum class ToneMapping {
+    Linear,
+    Reinhard,
+    ACES,
+    END
+};
+
+inline constexpr const char* toneMappingNames[] = { "Linear", "Reinhard", "ACES" };
+
+class Tonemapper {
+    public:
+        void apply(const Color* source, size_t count, unsigned char* destination) const {
+            const float* in = &source[0].x;
+            size_t floatCount = count * 3;
+            float scale = std::exp2(_exposure);
+
+            size_t i = 0;
+            for (; i + Float4::width <= floatCount; i += Float4::width)
+                map(Float4::load(in + i), Float4(scale)).storeBytes(destination + i);
+            for (; i < floatCount; i++)
+                destination[i] = static_cast<unsigned char>(map(in[i], scale) + 0.5f);
+        }
+
+        float& exposure() { return _exposure; }
+        ToneMapping& toneMapping() { return _toneMapping; }
+    private:
+        float _exposure = 0.0f;
+        ToneMapping _toneMapping = ToneMapping::ACES;
+
+        template<typename T>
+        T map(T x, T scale) const {
+            using std::min; using std::max; using std::pow;
+
+            x = max(x * scale, T(0.0f));
+
+            switch (_toneMapping) {
+                case ToneMapping::Reinhard:
+                    x = x / (x + T(1.0f));
+                    break;
+                case ToneMapping::ACES:
+                    x = (x * (T(2.51f) * x + T(0.03f))) / (x * (T(2.43f) * x + T(0.59f)) + T(0.14f));
+                    break;
+                default:
+                    break;
+            }
+
+            x = min(x, T(1.0f));
+
+            T encoded = select(x < T(0.0031308f), x * T(12.92f), T(1.055f) * pow(max(x, T(1e-8f)), 1.0f / 2.4f) - T(0.055f));
+            return encoded * T(255.0f);
+        }
+};
+
+#endif
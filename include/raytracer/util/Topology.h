@@ -0,0 +1,126 @@
+#ifndef TOPOLOGY_H
+#define TOPOLOGY_H
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#if defined(__linux__)
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+struct NumaNode {
+    int id;
+    std::vector<int> cpus;
+};
+
+class Topology {
+    public:
+        Topology() = default;
+        explicit Topology(std::vector<NumaNode> nodes) : _nodes(std::move(nodes)) {}
+
+        static const Topology& system() {
+            static Topology topology = detect();
+            return topology;
+        }
+
+        static Topology detect() {
+            Topology topology;
+#if defined(__linux__)
+            std::error_code error;
+            std::filesystem::directory_iterator nodes("/sys/devices/system/node", error);
+            for (const auto& entry : error ? std::filesystem::directory_iterator() : nodes) {
+                std::string name = entry.path().filename().string();
+                if (name.rfind("node", 0) != 0 || name.size() == 4 || !std::all_of(name.begin() + 4, name.end(), ::isdigit))
+                    continue;
+
+                std::ifstream file(entry.path() / "cpulist");
+                std::string list;
+                if (!std::getline(file, list))
+                    continue;
+
+                NumaNode node{std::stoi(name.substr(4)), parseCpuList(list)};
+                if (!node.cpus.empty())
+                    topology._nodes.push_back(node);
+            }
+            std::sort(topology._nodes.begin(), topology._nodes.end(), [](const NumaNode& a, const NumaNode& b) { return a.id < b.id; });
+#endif
+            if (topology._nodes.empty()) {
+                NumaNode node{0, {}};
+                for (int cpu = 0; cpu < std::max((int)std::thread::hardware_concurrency(), 1); cpu++)
+                    node.cpus.push_back(cpu);
+                topology._nodes.push_back(node);
+            }
+            return topology;
+        }
+
+        static std::vector<int> parseCpuList(const std::string& list) {
+            std::vector<int> cpus;
+            std::stringstream stream(list);
+            std::string range;
+            while (std::getline(stream, range, ',')) {
+                size_t dash = range.find('-');
+                try {
+                    int first = std::stoi(range.substr(0, dash));
+                    int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+                    for (int cpu = first; cpu <= last; cpu++)
+                        cpus.push_back(cpu);
+                } catch (const std::exception&) {
+                }
+            }
+            return cpus;
+        }
+
+        static bool pin(std::thread::native_handle_type thread, const std::vector<int>& cpus) {
+#if defined(__linux__)
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (int cpu : cpus) {
+                if (cpu >= 0 && cpu < CPU_SETSIZE)
+                    CPU_SET(cpu, &set);
+            }
+            return pthread_setaffinity_np(thread, sizeof(set), &set) == 0;
+#else
+            return false;
+#endif
+        }
+
+        static bool pinCurrentThread(const std::vector<int>& cpus) {
+#if defined(__linux__)
+            return pin(pthread_self(), cpus);
+#else
+            return false;
+#endif
+        }
+
+        int workerNode(int worker) const {
+            return worker % nodeCount();
+        }
+
+        int workerCpu(int worker) const {
+            const std::vector<int>& cpus = _nodes[workerNode(worker)].cpus;
+            return cpus[(worker / nodeCount()) % cpus.size()];
+        }
+
+        std::vector<int> allCpus() const {
+            std::vector<int> cpus;
+            for (const NumaNode& node : _nodes)
+                cpus.insert(cpus.end(), node.cpus.begin(), node.cpus.end());
+            return cpus;
+        }
+
+        int nodeCount() const { return (int)_nodes.size(); }
+        const NumaNode& node(int index) const { return _nodes[index]; }
+        const std::vector<NumaNode>& nodes() const { return _nodes; }
+    private:
+        std::vector<NumaNode> _nodes;
+};
+
+#endif
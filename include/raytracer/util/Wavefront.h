@@ -0,0 +1,261 @@
+#ifndef WAVEFRONT_H
+#define WAVEFRONT_H
+
+#include "../hittable/Hittable.h"
+#include "../light/RayLightList.h"
+#include "../light/LightSampler.h"
+#include "RayMaterial.h"
+#include "RenderBuffers.h"
+#include "RenderStats.h"
+#include <vector>
+#include <cstdint>
+#include <cfloat>
+#include <algorithm>
+
+enum class Integrator {
+    Megakernel,
+    Wavefront,
+    END
+};
+
+inline constexpr const char* integratorNames[] = { "Megakernel", "Wavefront" };
+
+struct WavefrontOptions {
+    bool sortRays = false;
+    bool cacheOccluders = true;
+};
+
+struct PathState {
+    Ray ray;
+    Color throughput{1.0f};
+    Color radiance{0.0f};
+    SampleFeatures features;
+    float scatterPdf = 0.0f;
+    int pixel = 0;
+};
+
+class WavefrontIntegrator {
+    public:
+        std::vector<PathState>& paths() { return _paths; }
+
+        void trace(int maxDepth, const Hittable& world, const RayLightList& lights, const Color& skyboxColor, const WavefrontOptions& options = {},
+                   LightSelection selection = LightSelection::All, int lightSamples = 1) {
+            _occluders.assign(lights.lights.size() + 1, nullptr);
+            _active.clear();
+            if (maxDepth > 0) {
+                for (int i = 0; i < (int)_paths.size(); i++)
+                    _active.push_back(i);
+            }
+
+            for (int depth = maxDepth; depth > 0 && !_active.empty(); depth--) {
+                bool primary = depth == maxDepth;
+                intersect(world);
+                shadeMisses(skyboxColor, primary);
+                traceShadows(world, lights, depth > 1 ? skyboxColor : Color(0.0f), options.cacheOccluders, selection, lightSamples);
+                shadeDirect(primary);
+                scatter();
+                if (options.sortRays)
+                    sortActive();
+            }
+        }
+
+        static WavefrontIntegrator& local() {
+            static thread_local WavefrontIntegrator integrator;
+            return integrator;
+        }
+    private:
+        struct ShadowQuery {
+            int hit;
+            int light;
+            Ray ray;
+            float distance;
+            float weight;
+            Color radiance;
+            bool occluded;
+        };
+
+        std::vector<PathState> _paths;
+        std::vector<int> _active;
+        std::vector<int> _next;
+        std::vector<HitRecord> _hits;
+        std::vector<uint8_t> _hitFlags;
+        std::vector<ShadowQuery> _shadows;
+        std::vector<ShadowQuery> _queries;
+        std::vector<int> _lightStart;
+        std::vector<LightChoice> _choices;
+        std::vector<LightSample> _samples;
+        std::vector<const Hittable*> _occluders;
+        std::vector<std::pair<uint64_t, int>> _keys;
+
+        void intersect(const Hittable& world) {
+            _hits.resize(_active.size());
+            _hitFlags.resize(_active.size());
+            for (size_t k = 0; k < _active.size(); k++) {
+                _hits[k] = HitRecord();
+                _hitFlags[k] = world.raymarch(_paths[_active[k]].ray, _hits[k]);
+            }
+        }
+
+        void shadeMisses(const Color& skyboxColor, bool primary) {
+            for (size_t k = 0; k < _active.size(); k++) {
+                PathState& path = _paths[_active[k]];
+                const HitRecord& rec = _hits[k];
+
+                if (!_hitFlags[k]) {
+                    float weight = path.scatterPdf > 0.0f ? powerHeuristic(path.scatterPdf, uniformHemispherePdf) : 1.0f;
+                    addRadiance(path, path.throughput * skyboxColor * weight, primary);
+                    continue;
+                }
+
+                RenderStats::count(Counter::PathVertices);
+                if (primary) {
+                    path.features.albedo = rec.material->albedo();
+                    path.features.normal = rec.normal;
+                    path.features.depth = glm::length(rec.point - path.ray.origin());
+                    path.features.objectId = rec.objectId;
+                    path.features.materialId = rec.material->id();
+                }
+            }
+        }
+
+        void traceShadows(const Hittable& world, const RayLightList& lights, const Color& skyColor, bool cacheOccluders, LightSelection selection, int lightSamples) {
+            int sky = (int)lights.lights.size();
+            _queries.clear();
+            _lightStart.assign(lights.lights.size() + 2, 0);
+            for (size_t k = 0; k < _active.size(); k++) {
+                if (!_hitFlags[k])
+                    continue;
+
+                const HitRecord& rec = _hits[k];
+                LightSampler::select(lights, rec.point, selection, lightSamples, _choices);
+                lights.evaluate(rec.point, _choices, _samples);
+                for (size_t i = 0; i < _choices.size(); i++) {
+                    const LightChoice& choice = _choices[i];
+                    const LightSample& sample = _samples[i];
+                    if (sample.radiance == Color(0.0f))
+                        continue;
+
+                    glm::vec3 lightDir = sample.direction;
+                    float biasAmount = 0.1f;
+                    glm::vec3 shadowOrigin = rec.point + rec.normal * biasAmount;
+
+                    float lightDist;
+                    if (sample.finite) {
+                        float projectedBias = glm::dot(rec.normal * biasAmount, lightDir);
+                        lightDist = sample.distance - projectedBias;
+                    } else {
+                        lightDist = 100.0f;
+                    }
+
+                    _queries.push_back({(int)k, choice.light, Ray(shadowOrigin, lightDir), lightDist, choice.weight, sample.radiance, false});
+                    _lightStart[choice.light + 1]++;
+                }
+
+                if (skyColor != Color(0.0f)) {
+                    const PathState& path = _paths[_active[k]];
+                    glm::vec3 skyDir = randomOnHemisphere(rec.normal);
+                    float weight = powerHeuristic(uniformHemispherePdf, rec.material->pdf(path.ray, rec, skyDir)) / uniformHemispherePdf;
+                    _queries.push_back({(int)k, sky, Ray(rec.point + rec.normal * 0.1f, skyDir), 100.0f, weight, skyColor, false});
+                    _lightStart[sky + 1]++;
+                }
+            }
+
+            for (size_t l = 1; l < _lightStart.size(); l++)
+                _lightStart[l] += _lightStart[l - 1];
+            _shadows.resize(_queries.size());
+            for (const ShadowQuery& query : _queries)
+                _shadows[_lightStart[query.light]++] = query;
+
+            RenderStats::count(Counter::ShadowRays, _shadows.size());
+            for (ShadowQuery& query : _shadows) {
+                const Hittable*& cached = _occluders[query.light];
+                if (cacheOccluders && cached) {
+                    if (cached->shadowMarch(query.ray, query.distance)) {
+                        RenderStats::count(Counter::OccluderCacheHits);
+                        query.occluded = true;
+                        continue;
+                    }
+                    cached = nullptr;
+                }
+
+                const Hittable* occluder = world.occluder(query.ray, query.distance);
+                query.occluded = occluder != nullptr;
+                if (occluder)
+                    cached = occluder;
+            }
+        }
+
+        void shadeDirect(bool primary) {
+            for (const ShadowQuery& query : _shadows) {
+                if (query.occluded)
+                    continue;
+
+                PathState& path = _paths[_active[query.hit]];
+                const HitRecord& rec = _hits[query.hit];
+                Color shaded = rec.material->shade(path.ray, rec, query.ray.direction(), query.radiance);
+                addRadiance(path, path.throughput * shaded * query.weight, primary);
+            }
+        }
+
+        void scatter() {
+            _next.clear();
+            for (size_t k = 0; k < _active.size(); k++) {
+                if (!_hitFlags[k])
+                    continue;
+
+                PathState& path = _paths[_active[k]];
+                Ray scattered;
+                Color attenuation;
+                if (_hits[k].material->scatter(path.ray, _hits[k], attenuation, scattered, path.scatterPdf)) {
+                    RenderStats::count(Counter::ScatterRays);
+                    path.throughput *= attenuation;
+                    path.ray = scattered;
+                    _next.push_back(_active[k]);
+                }
+            }
+            std::swap(_active, _next);
+        }
+
+        void sortActive() {
+            if (_active.size() < 2)
+                return;
+
+            glm::vec3 lo(FLT_MAX), hi(-FLT_MAX);
+            for (int index : _active) {
+                lo = glm::min(lo, _paths[index].ray.origin());
+                hi = glm::max(hi, _paths[index].ray.origin());
+            }
+            glm::vec3 scale = 1023.0f / glm::max(hi - lo, glm::vec3(1e-6f));
+
+            _keys.clear();
+            for (int index : _active) {
+                const Ray& ray = _paths[index].ray;
+                glm::uvec3 cell = glm::uvec3(glm::clamp((ray.origin() - lo) * scale, 0.0f, 1023.0f));
+                uint32_t octant = (ray.direction().x < 0.0f ? 1u : 0u) | (ray.direction().y < 0.0f ? 2u : 0u) | (ray.direction().z < 0.0f ? 4u : 0u);
+                uint32_t morton = spreadBits(cell.x) | (spreadBits(cell.y) << 1) | (spreadBits(cell.z) << 2);
+                _keys.push_back({(uint64_t(octant) << 30) | morton, index});
+            }
+
+            std::sort(_keys.begin(), _keys.end());
+            for (size_t k = 0; k < _keys.size(); k++)
+                _active[k] = _keys[k].second;
+        }
+
+        static uint32_t spreadBits(uint32_t v) {
+            v = (v | (v << 16)) & 0x030000ffu;
+            v = (v | (v << 8)) & 0x0300f00fu;
+            v = (v | (v << 4)) & 0x030c30c3u;
+            v = (v | (v << 2)) & 0x09249249u;
+            return v;
+        }
+
+        static void addRadiance(PathState& path, const Color& radiance, bool primary) {
+            path.radiance += radiance;
+            if (primary)
+                path.features.direct += radiance;
+            else
+                path.features.indirect += radiance;
+        }
+};
+
+#endif
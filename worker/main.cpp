@@ -0,0 +1,49 @@
+#define GLM_ENABLE_EXPERIMENTAL
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/euler_angles.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#include "editor/entity/util/Transform.h"
+#include "raytracer/distributed/RenderWorker.h"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static void printUsage() {
+    std::cout << "Usage: radiance-worker --connect ADDRESS [--threads N]\n";
+    std::cout << "  ADDRESS is unix:/path/to/socket or host:port\n";
+}
+
+int main(int argc, char** argv) {
+    std::string address;
+    int threads = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--connect" && hasValue) address = argv[++i];
+        else if (arg == "--threads" && hasValue) threads = std::max(std::atoi(argv[++i]), 1);
+        else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (address.empty()) {
+        printUsage();
+        return 1;
+    }
+
+    try {
+        RenderWorker worker(threads);
+        worker.run(address);
+    } catch (const std::exception& e) {
+        std::cerr << "radiance-worker: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}